@@ -64,7 +64,7 @@ void loop() {
                    225
     */
     NFCcard = nfc.getInformation();
-    if (NFCcard.AQTA[1] == 0x44 && memcmp(NFCcard.cardType, "Ultralight", 10) != 0) {
+    if (NFCcard.AQTA[1] == 0x44 && !DFRobot_PN532::isUltralight(NFCcard.type)) {
       Serial.println("---------------------------Here is the clear status-----------------------------");
       for (int i = 0; i < NFCcard.blockNumber; i++) {
         Serial.print("BLOCK ");
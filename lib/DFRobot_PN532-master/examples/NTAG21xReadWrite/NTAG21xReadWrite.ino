@@ -65,7 +65,7 @@ void loop() {
               ...                     user memory
               225
     */  NFCcard = nfc.getInformation();
-    if (NFCcard.AQTA[1] == 0x44 && memcmp(NFCcard.cardType, "Ultralight", 10) != 0) {
+    if (NFCcard.AQTA[1] == 0x44 && !DFRobot_PN532::isUltralight(NFCcard.type)) {
       Serial.print("Data to be written(HEX):");
       for (int i = 0; i < 4; i++) {
         Serial.print(dataWrite[i], HEX);
@@ -60,7 +60,7 @@ void loop() {
   //Initializes the values of all data blocks, setting them all to zero.
   if (nfc.scan()) {
     NFCcard = nfc.getInformation();
-    if (NFCcard.AQTA[1] == 0x44 && memcmp(NFCcard.cardType, "Ultralight", 10) == 0) {
+    if (NFCcard.AQTA[1] == 0x44 && DFRobot_PN532::isUltralight(NFCcard.type)) {
       for (int i = 0; i < 20 ; i++) {
         Serial.print("BLOCK "); Serial.print(i); Serial.print(":");
         if (i < 4 || i > NFCcard.blockNumber - 5) {
@@ -55,9 +55,11 @@ void loop() {
     Serial.println("");
     Serial.print("AQTA: "); Serial.print("0x"); Serial.print("0"); Serial.print(NFCcard.AQTA[0], HEX); Serial.print(""); Serial.println(NFCcard.AQTA[1], HEX);
     Serial.print("SAK: "); Serial.print("0x"); Serial.println(NFCcard.SAK, HEX);
-    Serial.print("Type: "); Serial.println(NFCcard.cardType);
-    Serial.print("Manufacturer:"); Serial.println(NFCcard.Manufacturer);
-    Serial.print("RF Technology:"); Serial.println(NFCcard.RFTechnology);
+    Serial.print("Type: "); Serial.println(DFRobot_PN532::cardTypeName(NFCcard.type));
+    if (NFCcard.type != DFRobot_PN532::CARD_TYPE_UNKNOWN) {
+      Serial.println("Manufacturer:NXP");
+      Serial.println("RF Technology:ISO/IEC14443-3,Type A");
+    }
     Serial.print("Memory Size:"); Serial.print(NFCcard.size); Serial.print(" bytes(total)/"); Serial.print(NFCcard.usersize); Serial.println(" bytes(available)");
     Serial.print("Block/Page Size:"); Serial.print(NFCcard.blockSize); Serial.println(" bytes");
     //Serial.print("Sector Size:"); Serial.print(NFCcard.sectorSize); Serial.println(" bytes");
@@ -10,127 +10,232 @@
 */
 #include"DFRobot_PN532.h"
 
+/* PN532_PROFILE_BEGIN on entry, PN532_PROFILE_END on every return (no code with the empty hooks) */
+struct sProfileScope{
+    sProfileScope(uint8_t p) : point(p) { PN532_PROFILE_BEGIN(p); }
+    ~sProfileScope() { PN532_PROFILE_END(point); }
+    uint8_t point;
+};
+#define PN532_PROFILE_SCOPE(point)           sProfileScope profileScope(point)
 
-uint8_t DFRobot_PN532::getUltraversion(uint8_t block){
+#define PN532_TEMPLATE      template <class Transport, class ReadyStrategy>
+#define PN532_CLASS         PN532<Transport, ReadyStrategy>
+
+/* Fixed commands, built by the compiler (see PN532_Frame) */
+typedef PN532_Frame<COMMAND_SAMCONFIGURATION, 0x01, 0x14, 0x01> samConfigurationFrame;   /* Normal mode, timeout 50ms * 20 = 1 second, use IRQ pin */
+typedef PN532_Frame<COMMAND_INLISTPASSIVETARGET, 1, MIFARE_ISO14443A> inListOneTargetFrame;
+typedef PN532_Frame<COMMAND_INLISTPASSIVETARGET, 2, MIFARE_ISO14443A> inListTwoTargetsFrame;
+static const uint8_t pn532Ack[6] PROGMEM = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+static const uint8_t pn532Nack[6] PROGMEM = {0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00};
+static const uint32_t hsuBaudRates[] PROGMEM = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1288000};  /* Index = BR of SetSerialBaudRate */
+
+/* Memory layout per card type (index: eCardType_t) */
+typedef struct{
+    uint16_t size;
+    uint16_t usersize;
+    uint8_t blockSize;
+    uint16_t blockNumber;
+    uint8_t sectorSize;
+}sCardLayout_t;
+
+static const sCardLayout_t cardLayouts[DFRobot_PN532::CARD_TYPE_COUNT] PROGMEM = {
+    {   0,    0,  0,   0,  0},   // Unknown
+    {1024,  752, 16,  64, 16},   // MIFARE Classic 1k
+    {4096, 3440, 16, 256, 39},   // MIFARE Classic 4k
+    {  64,   48,  4,  16,  1},   // Ultralight
+    {  80,   48,  4,  20,  1},   // Ultralight EV1 (MF0UL11)
+    { 164,  128,  4,  41,  1},   // Ultralight EV1 (MF0UL21)
+    {  80,   48,  4,  20,  1},   // NTAG 210
+    { 164,  128,  4,  41,  1},   // NTAG 212
+    { 180,  144,  4,  45,  1},   // NTAG 213
+    { 540,  504,  4, 135,  1},   // NTAG 215
+    { 924,  888,  4, 231,  1}    // NTAG 216
+};
+
+static const char cardNameUnknown[] PROGMEM = "Unknown";
+static const char cardNameClassic1k[] PROGMEM = "MIFARE Classic 1k";
+static const char cardNameClassic4k[] PROGMEM = "MIFARE Classic 4k";
+static const char cardNameUltralight[] PROGMEM = "Ultralight";
+static const char cardNameUltralightEV1_48[] PROGMEM = "Ultralight EV1 48";
+static const char cardNameUltralightEV1_128[] PROGMEM = "Ultralight EV1 128";
+static const char cardNameNTAG210[] PROGMEM = "NTAG 210";
+static const char cardNameNTAG212[] PROGMEM = "NTAG 212";
+static const char cardNameNTAG213[] PROGMEM = "NTAG 213";
+static const char cardNameNTAG215[] PROGMEM = "NTAG 215";
+static const char cardNameNTAG216[] PROGMEM = "NTAG 216";
+static const char * const cardNames[DFRobot_PN532::CARD_TYPE_COUNT] PROGMEM = {
+    cardNameUnknown, cardNameClassic1k, cardNameClassic4k, cardNameUltralight, cardNameUltralightEV1_48,
+    cardNameUltralightEV1_128, cardNameNTAG210, cardNameNTAG212, cardNameNTAG213, cardNameNTAG215, cardNameNTAG216
+};
+
+static const char statusNameOk[] PROGMEM = "OK";
+static const char statusNameNoResponse[] PROGMEM = "No response";
+static const char statusNameFrameError[] PROGMEM = "Frame error";
+static const char statusNameNoTarget[] PROGMEM = "No target";
+static const char statusNameRfTimeout[] PROGMEM = "RF timeout";
+static const char statusNameRfError[] PROGMEM = "RF error";
+static const char statusNameCommandError[] PROGMEM = "Command error";
+static const char * const statusNames[DFRobot_PN532::STATUS_COUNT] PROGMEM = {
+    statusNameOk, statusNameNoResponse, statusNameFrameError, statusNameNoTarget,
+    statusNameRfTimeout, statusNameRfError, statusNameCommandError
+};
+
+
+PN532_TEMPLATE
+uint8_t PN532_CLASS::readNTAGRaw(uint8_t block){
+    if(block > 231)
+        return -1;
     if(!this->nfcEnable)
         return -1;
-    if(!scan())
+    if(!selectTarget())
         return -1;
-    unsigned char cmdRead[4];
-        cmdRead[0] = COMMAND_INDATAEXCHANGE;
-        cmdRead[1] = 1;                   /* Card number */
-        cmdRead[2] = CARD_CMD_READING;     /* NTAG Read command = 0x30 */
-        cmdRead[3] = block; 
+    uint8_t cmdRead[4];
+    cmdRead[0] = COMMAND_INDATAEXCHANGE;
+    cmdRead[1] = targetNumber;        /* Card number (Tg) */
+    cmdRead[2] = CARD_CMD_READING;     /* NTAG Read command = 0x30 */
+    cmdRead[3] = block; 
     
     writeCommand(cmdRead,4);
-    if(!readAck(32))
+    if(readAck(32) && exchangeOk())
+        return 1;               /* 16 bytes (4 pages) in receiveACK[14..29] */
+    targetLost();
+    return -1;
+}
+
+PN532_TEMPLATE
+uint8_t PN532_CLASS::readNTAG(uint8_t *buffer,uint8_t block){
+    if(readNTAGRaw(block) != 1)
         return -1;
-    if(receiveACK[12] == 0x41 && receiveACK[13] == 0x00){
-    }
-    else
+    memcpy(buffer,&receiveACK[14],4);
+    return 1;
+}
+
+PN532_TEMPLATE
+uint8_t PN532_CLASS::readNTAGPages(uint8_t *buffer,uint8_t block){
+    if(readNTAGRaw(block) != 1)
         return -1;
+    memcpy(buffer,&receiveACK[14],4*NTAG_PAGES_PER_READ);
     return 1;
 }
-uint8_t DFRobot_PN532::readNTAG(uint8_t *buffer,uint8_t block){
-    if(block > 231)
+
+PN532_TEMPLATE
+uint8_t PN532_CLASS::fastReadNTAG(uint8_t *buffer,uint8_t startPage,uint8_t endPage){
+    if(endPage > 231 || startPage > endPage || (endPage - startPage) >= NTAG_FAST_READ_MAX_PAGES)
         return -1;
     if(!this->nfcEnable)
         return -1;
-    if(!scan())
+    if(!selectTarget())
         return -1;
-    uint8_t cmdRead[4];
+    uint8_t cmdRead[5];
     cmdRead[0] = COMMAND_INDATAEXCHANGE;
-    cmdRead[1] = 1;                   /* Card number */
-    cmdRead[2] = CARD_CMD_READING;     /* NTAG Read command = 0x30 */
-    cmdRead[3] = block; 
-    
-    writeCommand(cmdRead,4);
-    if(!readAck(32))
+    cmdRead[1] = targetNumber;             /* Card number (Tg) */
+    cmdRead[2] = CARD_CMD_FAST_READING;    /* NTAG21x Fast read command = 0x3A */
+    cmdRead[3] = startPage;
+    cmdRead[4] = endPage;
+    uint8_t bytes = 4*(endPage - startPage + 1);
+
+    writeCommand(cmdRead,5);
+    if(!readAck(16 + bytes)){
+        targetLost();
         return -1;
-    if(receiveACK[12] == 0x41 && receiveACK[13] == 0x00){
-        for(uint8_t i = 0;i<4;i++){
-            buffer[i] = receiveACK[14 + i];
+    }
+    if(exchangeOk()){
+        if(receiveACK[9] == bytes + 3){
+            memcpy(buffer,&receiveACK[14],bytes);
+            return 1;
         }
+        status = STATUS_FRAME_ERROR;
     }
-    else
-        return -1;
-    
-    return 1;
+    targetLost();
+    return -1;
 }
      
-bool  DFRobot_PN532::writeNTAG(int block, uint8_t data[]){
+PN532_TEMPLATE
+bool  PN532_CLASS::writeNTAG(int block, uint8_t data[]){
     if(block > 225 || block < 4)
         return false;
     if(!this->nfcEnable)
         return false;
-    if(!this->scan())
+    if(!this->selectTarget())
         return false;
     unsigned char cmdWrite[20];
         cmdWrite[0] = COMMAND_INDATAEXCHANGE;
-        cmdWrite[1] = 1;                      /* Card number */
+        cmdWrite[1] = targetNumber;           /* Card number (Tg) */
         cmdWrite[2] = CARD_CMD_WRITEINGTONTGE;       /* NTAG Write command = 0xA2 */
         cmdWrite[3] = block;
     for(int i = 4;i < 8;i++) {cmdWrite[i]=data[i - 4];}// Data to be written
     this->writeCommand(cmdWrite,8);
 
-    this->readAck(16);
+    if(!this->readAck(16) || !exchangeOk()){
+        targetLost();
+        return false;
+    }
     return true;
 
 }
 
-uint8_t DFRobot_PN532::readUltralight(uint8_t *buffer,uint8_t block){
+PN532_TEMPLATE
+uint8_t PN532_CLASS::readUltralight(uint8_t *buffer,uint8_t block){
     if(block > 41)
       return -1;
     if(!this->nfcEnable)
         return -1;
-    if(!scan())
+    if(!selectTarget())
         return -1;
     unsigned char cmdRead[4];
         cmdRead[0] = COMMAND_INDATAEXCHANGE;
-        cmdRead[1] = 1;                   /* Card number */
+        cmdRead[1] = targetNumber;        /* Card number (Tg) */
         cmdRead[2] = CARD_CMD_READING;     /* Ultralight Read command = 0x30 */
         cmdRead[3] = block; 
     
     writeCommand(cmdRead,4);
-    if(!readAck(22))
+    if(!readAck(16 + 4*NTAG_PAGES_PER_READ)){   /* READ always returns 4 pages (16 bytes) */
+        targetLost();
         return -1;
+    }
     if(receiveACK[12] == 0x41 && receiveACK[13] == 0x00){
         for(uint8_t i = 0;i<4;i++){
             buffer[i] = receiveACK[14 + i];
         }
                }
     else{
+        targetLost();
         return -1;
     }
     return 1;
 }
 
-bool DFRobot_PN532::writeUltralight(int block, uint8_t data[]){
+PN532_TEMPLATE
+bool PN532_CLASS::writeUltralight(int block, uint8_t data[]){
     if( block < 4)
         return false;
     if(!this->nfcEnable)
         return false;
-    if(!this->scan())
+    if(!this->selectTarget())
         return false;
     unsigned char cmdWrite[20];
         cmdWrite[0] = COMMAND_INDATAEXCHANGE;
-        cmdWrite[1] = 1;                      /* Card number */
+        cmdWrite[1] = targetNumber;           /* Card number (Tg) */
         cmdWrite[2] = CARD_CMD_WRITEINGTOULTRALIGHT;       /* Ultralight Write command = 0xA2 */
         cmdWrite[3] = block;
     for(int i = 4;i < 8;i++) cmdWrite[i]=data[i - 4];// Data to be written
     this->writeCommand(cmdWrite,8);
-    this->readAck(16);
+    if(!this->readAck(16) || receiveACK[12] != 0x41 || receiveACK[13] != 0x00){
+        targetLost();
+        return false;
+    }
     return true;
 
 }
 
-bool DFRobot_PN532::passWordCheck(int block,uint8_t id[],uint8_t st[])
+PN532_TEMPLATE
+bool PN532_CLASS::passWordCheck(int block,uint8_t id[],uint8_t st[])
 {   //bool success = false;
     if(!this->nfcEnable)
         return false;
     unsigned char cmdPassWord[14];
     cmdPassWord[0] = COMMAND_INDATAEXCHANGE;   /* Data Exchange Header */
-    cmdPassWord[1] = 1;                              /* The quantity number of the maxium card that can be detected in every research*/
+    cmdPassWord[1] = targetNumber;        /* The quantity number of the maxium card that can be detected in every research*/
     cmdPassWord[2] = 0x60;                          
     cmdPassWord[3] = block;
     for(int i = 4;i < 10;i++) cmdPassWord[i] = st[i - 4];              // PassWord
@@ -144,126 +249,114 @@ bool DFRobot_PN532::passWordCheck(int block,uint8_t id[],uint8_t st[])
     //  Serial.print(" ");
     //}
     /*! Only through 3 times checks, the received data will be confirmed as accurate*/
-    if(checkDCS(16) == 1 && receiveACK[12] == 0x41 && receiveACK[13] == 0x00)   
-        return true;
-    else
-        return false; 
+    if(!checkDCS(16)){
+        status = STATUS_FRAME_ERROR;
+        return false;
+    }
+    return exchangeOk();       /* Wrong key: PN532 error 0x14 -> STATUS_COMMAND_ERROR */
 }
-DFRobot_PN532:: sCard_t DFRobot_PN532::getInformation(){
+PN532_TEMPLATE
+DFRobot_PN532::sCard_t PN532_CLASS::getInformation(){
     sCard_t card;
-    uint8_t cmdnfcUid[11];
-    cmdnfcUid[0] = COMMAND_INLISTPASSIVETARGET;
-    cmdnfcUid[1] = 1;                              // The quantity number of the maxium card that can be detected in every research
-    cmdnfcUid[2] = MIFARE_ISO14443A;
-    writeCommand(cmdnfcUid,3);
-    readAck(28);
-    for(int i = 0; i < receiveACK[18]; i++)
-        nfcUid[i] = receiveACK[i + 19];
-    
-    /*for(int i= 0 ; i<32 ;i++){
-        Serial.print(receiveACK[i],HEX);
-        Serial.print(" ");
-    }*/
-    //Serial.println(" ");
-    card.AQTA[0] = receiveACK[15];
-    card.AQTA[1] = receiveACK[16];
-    card.SAK = receiveACK[17];
-    memcpy(card.uid,receiveACK+19,receiveACK[18]);
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x04){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",20);
-        memcpy(card.cardType,"MIFARE Classic 1k",17);
-        card.uidlenght = 4;
-        memcpy(card.Manufacturer,"NXP",3);
-        card.size = 1024;
-        card.usersize = 752;
-        card.blockSize = 16;
-        card.blockNumber = 64;
-        card.sectorSize = 16;
-    }
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x44 && getUltraversion(230) == 1){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",25);
-        memcpy(card.cardType,"NTAG 216",8);
-        memcpy(card.Manufacturer,"NXP",4);
-        card.uidlenght = 7;
-        card.size = 924;
-        card.usersize = 888;
-        card.blockSize = 4;
-        card.blockNumber = 231;
-        card.sectorSize = 1;
-    }
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x44 && getUltraversion(230) != 1 && getUltraversion(134) == 1){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",25);
-        memcpy(card.cardType,"NTAG 215",8);
-        memcpy(card.Manufacturer,"NXP",4);
-        card.uidlenght = 7;
-        card.size = 540;
-        card.usersize = 504;
-        card.blockSize = 4;
-        card.blockNumber = 135;
-        card.sectorSize = 1;
-    }
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x44 && getUltraversion(134) != 1 && getUltraversion(44) == 1){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",25);
-        memcpy(card.cardType,"NTAG 213",8);
-        memcpy(card.Manufacturer,"NXP",4);
-        card.usersize = 144;
-        card.uidlenght = 7;
-        card.size = 180;
-        card.blockSize = 4;
-        card.blockNumber = 45;
-        card.sectorSize = 1;
-    }
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x44 && getUltraversion(44) != 1 && getUltraversion(40) == 1){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",25);
-        memcpy(card.cardType,"Ultralight",10);
-        memcpy(card.Manufacturer,"NXP",4);
-        card.usersize = 128;
-        card.uidlenght = 7;
-        card.size = 164;
-        card.blockSize = 4;
-        card.blockNumber = 41;
-        card.sectorSize = 1;
-    }
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x44 && getUltraversion(40) != 1 && getUltraversion(19) == 1){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",25);
-        memcpy(card.cardType,"Ultralight",10);
-        memcpy(card.Manufacturer,"NXP",4);
-        card.usersize = 48;
-        card.uidlenght = 7;
-        card.size = 80;
-        card.blockSize = 4;
-        card.blockNumber = 20;
-        card.sectorSize = 1;
+    memset(&card,0,sizeof(card));
+    if(scanTargets(1) == 0)
+        return card;
+    card.AQTA[0] = targets[0].ATQA[0];
+    card.AQTA[1] = targets[0].ATQA[1];
+    card.SAK = targets[0].SAK;
+    card.uidlenght = targets[0].uidLength;
+    memcpy(card.uid,targets[0].uid,card.uidlenght);
+    card.type = identifyTarget(0);
+    sCardLayout_t layout;
+    memcpy_P(&layout,&cardLayouts[card.type],sizeof(layout));
+    card.size = layout.size;
+    card.usersize = layout.usersize;
+    card.blockSize = layout.blockSize;
+    card.blockNumber = layout.blockNumber;
+    card.sectorSize = layout.sectorSize;
+    return card;    
+}
+
+PN532_TEMPLATE
+uint8_t PN532_CLASS::getVersion(uint8_t *version){
+    if(!this->nfcEnable)
+        return -1;
+    if(!selectTarget())
+        return -1;
+    uint8_t cmdVersion[3];
+    cmdVersion[0] = COMMAND_INDATAEXCHANGE;
+    cmdVersion[1] = targetNumber;        /* Card number (Tg) */
+    cmdVersion[2] = CARD_CMD_GET_VERSION;
+    writeCommand(cmdVersion,3);
+    if(!readAck(24)){
+        targetLost();
+        return -1;
     }
-    
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x44 && getUltraversion(19) != 1 && getUltraversion(14) == 1){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",25);
-        memcpy(card.cardType,"Ultralight",10);
-        memcpy(card.Manufacturer,"NXP",4);
-        card.uidlenght = 7;
-        card.size = 448;
-        card.usersize = 320;
-        card.blockSize = 4;
-        card.blockNumber = 41;
-        card.sectorSize = 1;
+    if(receiveACK[12] == 0x41 && receiveACK[13] == 0x00 && receiveACK[9] == 8 + 3){
+        memcpy(version,&receiveACK[14],8);
+        return 1;
     }
-    
-    
-    
-    if(card.AQTA[0] == 0x00 && card.AQTA[1] ==0x02){
-        memcpy(card.RFTechnology,"ISO/IEC1443-3,Type A",20);
-        memcpy(card.cardType,"MIFARE Classic 4k",17);
-        memcpy(card.Manufacturer,"NXP",3);
-        card.uidlenght = 7;
-        card.size = 4096;
-        card.usersize = 3440;
-        card.blockSize = 16;
-        card.blockNumber = 256;
-        card.sectorSize = 39;
+    targetLost();               /* NAK: tag is back in IDLE state */
+    return (receiveACK[12] == 0x41) ? 0 : -1;
+}
+
+/* Without selectTarget(): the tag is still active from the last InListPassiveTarget.
+   Tags that are not active any more after listing one by one (tg 0) are selected by UID first. */
+PN532_TEMPLATE
+DFRobot_PN532::eCardType_t PN532_CLASS::identifyTarget(uint8_t index){
+    if(index >= targetCount)
+        return CARD_TYPE_UNKNOWN;
+    const sTarget_t *target = &targets[index];
+    if(target->ATQA[0] == 0x00 && target->ATQA[1] == 0x04)
+        return CARD_TYPE_MIFARE_CLASSIC_1K;
+    if(target->ATQA[0] == 0x00 && target->ATQA[1] == 0x02)
+        return CARD_TYPE_MIFARE_CLASSIC_4K;
+    if(target->ATQA[0] != 0x00 || target->ATQA[1] != 0x44)
+        return CARD_TYPE_UNKNOWN;
+    if(target->tg == 0 && !findTarget(target->uid,target->uidLength))
+        return CARD_TYPE_UNKNOWN;
+    uint8_t cmdVersion[3];
+    cmdVersion[0] = COMMAND_INDATAEXCHANGE;
+    cmdVersion[1] = target->tg;          /* Card number (Tg) */
+    cmdVersion[2] = CARD_CMD_GET_VERSION;
+    writeCommand(cmdVersion,3);
+    if(!readAck(24) || receiveACK[12] != 0x41)
+        return CARD_TYPE_UNKNOWN;
+    if(receiveACK[13] != 0x00 || receiveACK[9] != 8 + 3){
+        targetLost();                    /* NAK: tag is back in IDLE state */
+        return CARD_TYPE_ULTRALIGHT;     /* GET_VERSION not supported */
     }
-    
-    
-    return card;    
+    const uint8_t *version = &receiveACK[14];   /* Header, vendor, type, subtype, major, minor, storage size, protocol */
+    if(version[2] == 0x04){                     /* NTAG */
+        switch(version[6]){
+            case 0x0B: return CARD_TYPE_NTAG210;
+            case 0x0E: return CARD_TYPE_NTAG212;
+            case 0x0F: return CARD_TYPE_NTAG213;
+            case 0x11: return CARD_TYPE_NTAG215;
+            case 0x13: return CARD_TYPE_NTAG216;
+        }
+    }
+    else if(version[2] == 0x03){                /* Ultralight EV1 */
+        if(version[6] == 0x0B)
+            return CARD_TYPE_ULTRALIGHT_EV1_48;
+        if(version[6] == 0x0E)
+            return CARD_TYPE_ULTRALIGHT_EV1_128;
+    }
+    return CARD_TYPE_UNKNOWN;
+}
+
+const __FlashStringHelper * DFRobot_PN532::cardTypeName(eCardType_t type){
+    if(type >= CARD_TYPE_COUNT)
+        type = CARD_TYPE_UNKNOWN;
+    return (const __FlashStringHelper *)pgm_read_ptr(&cardNames[type]);
+}
+
+bool DFRobot_PN532::isNTAG(eCardType_t type){
+    return (type >= CARD_TYPE_NTAG210) && (type <= CARD_TYPE_NTAG216);
+}
+
+bool DFRobot_PN532::isUltralight(eCardType_t type){
+    return (type >= CARD_TYPE_ULTRALIGHT) && (type <= CARD_TYPE_ULTRALIGHT_EV1_128);
 }
 bool DFRobot_PN532::checkDCS(int x)  
 {
@@ -283,7 +376,8 @@ bool DFRobot_PN532::checkDCS(int x)
     else
         return false;
 }
-bool DFRobot_PN532::writeData(int block, uint8_t data[])
+PN532_TEMPLATE
+bool PN532_CLASS::writeData(int block, uint8_t data[])
 {   if(block < 128 && ( (block + 1)%4 == 0 || block ==0 ))
         return false;
     if((block >127 && block <256) && ((block + 1)%16 == 0))
@@ -298,7 +392,7 @@ bool DFRobot_PN532::writeData(int block, uint8_t data[])
         return false;
     unsigned char cmdWrite[20];
         cmdWrite[0] = COMMAND_INDATAEXCHANGE;
-        cmdWrite[1] = 1;                                     /* Card number */
+        cmdWrite[1] = targetNumber;                          /* Card number (Tg) */
         cmdWrite[2] = CARD_CMD_WRITEINGTOMIFARECLASSIC;       /* MifareClassic Write command = 0xA0 */
         cmdWrite[3] = block;
     for(int i = 4;i < 20;i++) cmdWrite[i]=data[i - 4];// Data to be written
@@ -307,140 +401,440 @@ bool DFRobot_PN532::writeData(int block, uint8_t data[])
     return true;
 }
 
-void DFRobot_PN532::writeData(int block, uint8_t index, uint8_t data)
+PN532_TEMPLATE
+void PN532_CLASS::writeData(int block, uint8_t index, uint8_t data)
 {
     if(!this->nfcEnable)
         return;
     index = max(min(index,16),1);
-    this->readData(block);
+    if(block > 255 || this->readBlock(this->blockData,block) != STATUS_OK)
+        return;                 /* Do not write back a stale block */
     this->blockData[index - 1] = data;
     this->writeData(block, this->blockData);
 }
-uint8_t DFRobot_PN532::readData(int block, uint8_t offset)
+PN532_TEMPLATE
+uint8_t PN532_CLASS::readData(int block, uint8_t offset)
 {
-    if(!this->nfcEnable)
-        return -1;
-    String error = this->readData(block);
-    if(error == "no card!" || error == "read error!" || error =="unknown error!"
-                        || error == "read timeout!" || error == "wake up error!")
+    if(block > 255 || this->readBlock(this->blockData,block) != STATUS_OK)
         return -1;
     return this->blockData[offset - 1];
 }
 
-bool DFRobot_PN532::scan(String nfcUid)
+PN532_TEMPLATE
+bool PN532_CLASS::beginSession()
 {
-    if(!this->nfcEnable)
+    sessionActive = true;
+    targetSelected = false;
+    sessionUidLength = 0;
+    return selectTarget();
+}
+
+PN532_TEMPLATE
+bool PN532_CLASS::beginSession(const uint8_t *uid, uint8_t uidLength)
+{
+    sessionActive = true;
+    targetSelected = false;
+    sessionUidLength = (uidLength > 7) ? 7 : uidLength;
+    memcpy(sessionUid,uid,sessionUidLength);
+    return selectTarget();
+}
+
+void DFRobot_PN532::endSession()
+{
+    sessionActive = false;
+    targetSelected = false;
+}
+
+/* Select the tag for a page operation. Outside a session every operation scans (original behaviour).
+   A session bound to a UID lists all tags and addresses the matching one by its target number.
+   If the transport receives only one target per InListPassiveTarget, the tags are listed one after
+   the other until the bound UID answers. */
+PN532_TEMPLATE
+bool PN532_CLASS::selectTarget()
+{
+    if(sessionActive && targetSelected)
+        return true;
+    if(!sessionActive || sessionUidLength == 0){
+        if(!scan())
+            return false;
+        if(!sessionActive)
+            return true;
+        sessionUidLength = targetUidLength;
+        memcpy(sessionUid,targetUid,targetUidLength);
+        targetSelected = true;
+        return true;
+    }
+    if(Transport::maxTargets < PN532_MAX_TARGETS){
+        targetSelected = findTarget(sessionUid,sessionUidLength);
+        return targetSelected;
+    }
+    if(scanTargets(PN532_MAX_TARGETS) == 0)
         return false;
-    if(this->scan())
-    {
-        String nfcUidSrt = "";
-        for(int i=0; i<4; i++)
-        {
-            if(this->nfcUid[i] <= 0x0f){
-                nfcUidSrt += "0";
-                nfcUidSrt += String(this->nfcUid[i],HEX);
-            }
-            else
-                nfcUidSrt += String(this->nfcUid[i],HEX);
-        }
-        if(nfcUid == nfcUidSrt)
+    for(uint8_t i = 0; i < targetCount; i++){
+        if(targets[i].uidLength == sessionUidLength && memcmp(targets[i].uid,sessionUid,sessionUidLength) == 0){
+            targetNumber = targets[i].tg;
+            targetUidLength = targets[i].uidLength;
+            memcpy(targetUid,targets[i].uid,targetUidLength);
+            targetSelected = true;
             return true;
+        }
     }
+    status = STATUS_NO_TARGET;  /* Tag not in the field (or only other tags) */
+    return false;
+}
+
+/* RF or timeout error: the tag has to be selected again before the next page operation */
+void DFRobot_PN532::targetLost()
+{
+    targetSelected = false;
+    activeUidLength = 0;        /* NAK/RF error: the tag is back in IDLE */
+}
+
+/* InDataExchange response in receiveACK: classify the PN532 status byte (UM0701-02, table 15) */
+bool DFRobot_PN532::exchangeOk()
+{
+    if(receiveACK[12] != 0x41){
+        status = STATUS_FRAME_ERROR;
+        return false;
+    }
+    uint8_t error = receiveACK[13] & 0x3F;       /* Bit 6: MI (more information), bit 7: NAD */
+    if(error == 0x00)
+        status = STATUS_OK;
+    else if(error == 0x01)
+        status = STATUS_RF_TIMEOUT;
+    else if(error <= 0x07)
+        status = STATUS_RF_ERROR;
+    else
+        status = STATUS_COMMAND_ERROR;
+    return (status == STATUS_OK);
+}
+
+const __FlashStringHelper * DFRobot_PN532::statusName(eStatus_t status){
+    if(status >= STATUS_COUNT)
+        status = STATUS_COMMAND_ERROR;
+    return (const __FlashStringHelper *)pgm_read_ptr(&statusNames[status]);
+}
+
+PN532_TEMPLATE
+bool PN532_CLASS::scan(const String &nfcUid)
+{
+    if(!this->scan())
+        return false;
+    char hex[2*7 + 1];
+    uidToHex(targetUid,targetUidLength,hex);
+    if(nfcUid == hex)                   /* Full UID */
+        return true;
+    hex[2*4] = '\0';
+    if(nfcUid == hex)                   /* First 4 bytes (original behaviour) */
+        return true;
+    status = STATUS_NO_TARGET;
     return false;
 }
 
-bool DFRobot_PN532::scan()
-{   if(!this->nfcEnable)
+PN532_TEMPLATE
+bool PN532_CLASS::scan(const uint8_t *uid, uint8_t uidLength)
+{
+    if(!this->scan())
+        return false;
+    if(targetUidLength != uidLength || memcmp(targetUid,uid,uidLength) != 0){
+        status = STATUS_NO_TARGET;      /* Another tag */
+        return false;
+    }
+    return true;
+}
+
+PN532_TEMPLATE
+bool PN532_CLASS::scan()
+{   PN532_PROFILE_SCOPE(PN532_PROFILE_SCAN);
+    if(!this->nfcEnable){
+        status = STATUS_NO_RESPONSE;
         return false;
-    uint8_t cmdnfcUid[11];
-    cmdnfcUid[0] = COMMAND_INLISTPASSIVETARGET;
-    cmdnfcUid[1] = 1;                              // The quantity number of the maxium card that can be detected in every research
-    cmdnfcUid[2] = MIFARE_ISO14443A;
-    writeCommand(cmdnfcUid,3);
-    if(!readAck(25))
+    }
+    activeUidLength = 0;
+    writeFrame_P(inListOneTargetFrame::data,inListOneTargetFrame::length);   // At most one card per research
+    if(!readAck(28))
         return false;
+    status = STATUS_NO_TARGET;
     for(int i = 0; i < 4; i++)
         nfcUid[i] = receiveACK[i + 19];
+    targetUidLength = (receiveACK[18] > 7) ? 7 : receiveACK[18];
+    memcpy(targetUid,&receiveACK[19],targetUidLength);
     /*for(int i= 0 ; i<32 ;i++){
         Serial.print(receiveACK[i]);
         Serial.print(" ");
     }*/
     if(receiveACK[13]!=1)
         return false;
+    status = STATUS_OK;
+    targetNumber = receiveACK[14];
     return true;
 }
 
-String DFRobot_PN532::readUid()
-{   if(!this->nfcEnable)
-        return "wake up error!";
-    if(!scan())
-        return "no card!";
-    String nfcUidSrt = "";
-    for(int i = 0; i < 4; i++)
-    {
-        if(nfcUid[i] <= 0x0f){
-            nfcUidSrt += "0";
-            nfcUidSrt += String(nfcUid[i],HEX);
+PN532_TEMPLATE
+uint8_t PN532_CLASS::scanTargets(uint8_t maxTargets)
+{
+    PN532_PROFILE_SCOPE(PN532_PROFILE_SCAN);
+    targetCount = 0;
+    if(!this->nfcEnable)
+        return 0;
+    if(maxTargets > PN532_MAX_TARGETS)
+        maxTargets = PN532_MAX_TARGETS;
+    if(maxTargets == 0)
+        maxTargets = 1;
+    if(maxTargets <= Transport::maxTargets){
+        targetCount = listTargets(maxTargets,targets);
+    }
+    else{
+        /* One target per InListPassiveTarget (AVR I2C): list the tags one after the other.
+           The active tag falls back to IDLE without answering, so the next InListPassiveTarget
+           finds another tag; only after a retry of the PN532 the same tag answers again. */
+        targetLost();
+        while(targetCount < maxTargets && listTargets(1,&targets[targetCount]) == 1){
+            const sTarget_t *target = &targets[targetCount];
+            bool listed = false;          /* Same tag again: no further tag */
+            for(uint8_t i = 0; i < targetCount; i++){
+                bool same = (targets[i].uidLength == target->uidLength && memcmp(targets[i].uid,target->uid,target->uidLength) == 0);
+                targets[i].tg = same ? target->tg : 0;   /* Not active any more: selected by UID (findTarget) */
+                listed = listed || same;
+            }
+            if(listed)
+                break;
+            targetCount++;
         }
-        else
-            nfcUidSrt += String(nfcUid[i],HEX);
     }
-    return nfcUidSrt;
+    if(targetCount == 0)
+        return 0;
+    status = STATUS_OK;
+    targetNumber = targets[0].tg;
+    targetUidLength = targets[0].uidLength;
+    memcpy(targetUid,targets[0].uid,targetUidLength);
+    memcpy(nfcUid,targets[0].uid,4);
+    return targetCount;
 }
 
+/* One InListPassiveTarget for up to maxTargets tags; the entries are stored in found */
+PN532_TEMPLATE
+uint8_t PN532_CLASS::listTargets(uint8_t maxTargets, sTarget_t *found)
+{
+    activeUidLength = 0;
+    if(maxTargets == 1)                            // MaxTg
+        writeFrame_P(inListOneTargetFrame::data,inListOneTargetFrame::length);
+    else
+        writeFrame_P(inListTwoTargetsFrame::data,inListTwoTargetsFrame::length);
+    if(!readAck(6 + PN532_INLIST_FRAME_SIZE(maxTargets)))
+        return 0;
+    status = (receiveACK[12] != 0x4B || receiveACK[13] > maxTargets) ? STATUS_FRAME_ERROR : STATUS_NO_TARGET;
+    if(receiveACK[12] != 0x4B || receiveACK[13] == 0 || receiveACK[13] > maxTargets)
+        return 0;
+    uint8_t end = 11 + receiveACK[9];             // End of the frame data (first byte after TFI..PD)
+    uint8_t i = 14;
+    uint8_t count = 0;
+    for(uint8_t n = 0; n < receiveACK[13]; n++){
+        if(i + 5 > end || receiveACK[i + 4] > 7 || i + 5 + receiveACK[i + 4] > end)
+            break;
+        sTarget_t *target = &found[count++];
+        target->tg = receiveACK[i];
+        target->ATQA[0] = receiveACK[i + 1];
+        target->ATQA[1] = receiveACK[i + 2];
+        target->SAK = receiveACK[i + 3];
+        target->uidLength = receiveACK[i + 4];
+        memcpy(target->uid,&receiveACK[i + 5],target->uidLength);
+        i += 5 + target->uidLength;
+        if((target->SAK & 0x20) && i < end)       // ISO14443-4 compliant: ATS follows (first byte = length)
+            i += receiveACK[i];
+    }
+    if(maxTargets == 1 && count == 1){           // Reused by findTarget() while it stays active
+        activeTg = found[0].tg;
+        activeUidLength = found[0].uidLength;
+        memcpy(activeUid,found[0].uid,activeUidLength);
+    }
+    return count;
+}
 
-uint8_t DFRobot_PN532::readData(uint8_t *buffer,uint8_t block){
-    if(!this->nfcEnable)
-        return -1;
-    String error = this->readData(block);
-    if(error == "no card!" || error == "read error!" || error =="unknown error!"
-                        || error == "read timeout!" || error == "wake up error!" ||error =="flase")
+/* One target per InListPassiveTarget: the tag is used without listing if it is still active from the last
+   InListPassiveTarget. Otherwise the tags are listed until the tag with this UID answers; the active tag
+   does not answer the next REQA, so at most PN532_MAX_TARGETS lists are needed.
+   Entries of targets[] get the new Tg or 0 (not active). */
+PN532_TEMPLATE
+bool PN532_CLASS::findTarget(const uint8_t *uid, uint8_t uidLength)
+{
+    if(activeUidLength == uidLength && memcmp(activeUid,uid,uidLength) == 0){
+        status = STATUS_OK;
+        targetNumber = activeTg;
+        targetUidLength = activeUidLength;
+        memcpy(targetUid,activeUid,targetUidLength);
+        return true;
+    }
+    sTarget_t found;
+    for(uint8_t n = 0; n < PN532_MAX_TARGETS && listTargets(1,&found) == 1; n++){
+        bool same = (found.uidLength == uidLength && memcmp(found.uid,uid,uidLength) == 0);
+        for(uint8_t i = 0; i < targetCount; i++)
+            targets[i].tg = (targets[i].uidLength == found.uidLength && memcmp(targets[i].uid,found.uid,found.uidLength) == 0) ? found.tg : 0;
+        if(same){
+            status = STATUS_OK;
+            targetNumber = found.tg;
+            targetUidLength = found.uidLength;
+            memcpy(targetUid,found.uid,targetUidLength);
+            return true;
+        }
+    }
+    status = STATUS_NO_TARGET;  /* Tag not in the field (or only other tags) */
+    return false;
+}
+
+PN532_TEMPLATE
+String PN532_CLASS::readUid()
+{   uint8_t uid[7];
+    uint8_t uidLength;
+    if(readUid(uid,&uidLength) != STATUS_OK)
+        return this->nfcEnable ? "no card!" : "wake up error!";
+    char hex[2*4 + 1];
+    uidToHex(uid,4,hex);
+    return String(hex);
+}
+
+PN532_TEMPLATE
+DFRobot_PN532::eStatus_t PN532_CLASS::readUid(uint8_t *uid, uint8_t *uidLength)
+{
+    *uidLength = 0;
+    if(!scan())
+        return status;
+    memcpy(uid,targetUid,targetUidLength);
+    *uidLength = targetUidLength;
+    return STATUS_OK;
+}
+
+uint8_t DFRobot_PN532::uidToHex(const uint8_t *uid, uint8_t uidLength, char *hex)
+{
+    if(uidLength > 7)
+        uidLength = 7;
+    for(uint8_t i = 0; i < uidLength; i++){
+        uint8_t high = uid[i] >> 4, low = uid[i] & 0x0F;
+        hex[2*i] = (high < 10) ? ('0' + high) : ('a' + high - 10);
+        hex[2*i + 1] = (low < 10) ? ('0' + low) : ('a' + low - 10);
+    }
+    hex[2*uidLength] = '\0';
+    return 2*uidLength;
+}
+
+
+PN532_TEMPLATE
+uint8_t PN532_CLASS::readData(uint8_t *buffer,uint8_t block){
+    if(readBlock(blockData,block) != STATUS_OK)
         return -1;
     memcpy(buffer,blockData,16);
     return  1;
     
 }
-String DFRobot_PN532::readData(int page) {
-    if (page > 255)
-        return "flase";
-    if(!this->nfcEnable)
-        return "wake up error!";
+
+PN532_TEMPLATE
+DFRobot_PN532::eStatus_t PN532_CLASS::readBlock(uint8_t *buffer,uint8_t block){
     if(!scan())
-        return "no card!";
-    if(!passWordCheck(page,nfcUid,nfcPassword))
-        return "read error!";
+        return status;
+    if(!passWordCheck(block,nfcUid,nfcPassword))
+        return status;
     unsigned char cmdRead[4];
         cmdRead[0] = COMMAND_INDATAEXCHANGE;
-        cmdRead[1] = 1;                   /* Card number */
+        cmdRead[1] = targetNumber;        /* Card number (Tg) */
         cmdRead[2] = CARD_CMD_READING;     /* Mifare Read command = 0x30 */
-        cmdRead[3] = page; 
+        cmdRead[3] = block; 
     
     writeCommand(cmdRead,4);
     if(!readAck(32))
-        return "read timeout!";
-    String dataSrt = "";
-    if(checkDCS(32) == 1 && receiveACK[12] == 0x41 && receiveACK[13] == 0x00){
-        for(int i = 0; i<16; i++)
-        {
-            blockData[i] = receiveACK[i + 14];
-            if(receiveACK[i+14]<=0x0f){
-                dataSrt += "0";
-                dataSrt += String(receiveACK[i + 14],HEX);
-            }
-            else
-                dataSrt += String(receiveACK[i + 14],HEX);
-            if(i<15) dataSrt += " ";
-        }
+        return status;
+    if(!checkDCS(32))
+        return status = STATUS_FRAME_ERROR;
+    if(!exchangeOk())
+        return status;
+    memcpy(buffer,&receiveACK[14],16);
+    return STATUS_OK;
+}
+PN532_TEMPLATE
+bool PN532_CLASS::setPassiveActivationRetries(uint8_t maxRetries) {
+    unsigned char cmdWrite[5];
+    cmdWrite[0] = COMMAND_RFCONFIGURATION;
+    cmdWrite[1] = 0x05;       // CfgItem: MaxRetries
+    cmdWrite[2] = 0xFF;       // MxRtyATR (default)
+    cmdWrite[3] = 0x01;       // MxRtyPSL (default)
+    cmdWrite[4] = maxRetries; // MxRtyPassiveActivation
+    writeCommand(cmdWrite,5);
+    return readAck(14) && (receiveACK[12] == 0x33);
+}
+
+PN532_TEMPLATE
+bool PN532_CLASS::begin(void) {   //nfc Module initialization  
+    memset(this->nfcPassword,0xff,6);
+    if(!transport.begin(*this))
+        return false;
+    nfcEnable = true;
+    writeFrame_P(samConfigurationFrame::data,samConfigurationFrame::length);
+    
+    if(readAck(14)!= 1){
+        
+        return false;
     }
-    return dataSrt;
+    if(receiveACK[12] != 0x15)
+        return false;
+    /* InListPassiveTarget answers "no card" after a few tries instead of waiting for a card forever */
+    return setPassiveActivationRetries(PN532_PASSIVE_ACTIVATION_RETRIES);
+}
+
+PN532_TEMPLATE
+PN532_CLASS::PN532(uint8_t irq){
+    _irq = irq;
+    _mode = 0;
+    if(ReadyStrategy::useIrq(*this))
+        _mode = 1;
+    if(irq != 0xFF)
+        pinMode(_irq, INPUT);
+    maxTargetsPerScan = Transport::maxTargets;
+}
+
+DFRobot_PN532_IIC::DFRobot_PN532_IIC(uint8_t irq,uint8_t mode) : PN532(irq){
+    _mode = mode;
+}
+
+#ifdef ESP_PLATFORM
+bool DFRobot_PN532_UART::begin(HardwareSerial *serial, int rx, int tx)
+{   this->uartTimeout = 1000;
+    this->transport.serial = serial;
+    serial->begin(PN532_HSU_BAUD,rx,tx);
+    return PN532::begin();
+}
+#else
+bool DFRobot_PN532_UART::begin(HardwareSerial *serial)
+{   this->uartTimeout = 1000;
+    this->transport.serial = serial;
+    serial->begin(PN532_HSU_BAUD);
+    return PN532::begin();
 }
+#endif
+
 /*
     Send commands to the chip through the iic ports*/
 
-void DFRobot_PN532_IIC::writeCommand(uint8_t* cmd, uint8_t cmdlen) {     
+bool PN532_I2C::begin(DFRobot_PN532 &nfc) {
+    (void)nfc;
+    Wire.begin();
+    awake = false;
+    return true;
+}
+
+/* The PN532 leaves power down on the I2C address match and needs a moment before it takes a frame.
+   Only the first command after begin() or after a command without answer has to wait. */
+void PN532_I2C::wakeUp(void) {
+    if(!awake){
+        delay(PN532_I2C_WAKEUP_MS);
+        awake = true;
+    }
+}
+
+void PN532_I2C::writeCommand(DFRobot_PN532 &nfc, const uint8_t* cmd, uint8_t cmdlen) {     
+    PN532_PROFILE_SCOPE(PN532_PROFILE_WRITE_COMMAND);
+    (void)nfc;
     uint8_t checksum;
     cmdlen++;
-    delay(2);     // Delay for random time to wake up NFC module
+    wakeUp();
     // I2C START
     Wire.beginTransmission(I2C_ADDRESS);
     checksum = PN532_PREAMBLE + PN532_STARTCODE1 + PN532_STARTCODE2;
@@ -457,7 +851,8 @@ void DFRobot_PN532_IIC::writeCommand(uint8_t* cmd, uint8_t cmdlen) {
     }
     Wire.write((byte)~checksum);
     Wire.write((byte)PN532_POSTAMBLE);
-    Wire.endTransmission();
+    if(Wire.endTransmission() != 0)
+        awake = false;            // Address not acknowledged: the PN532 was asleep and wakes up now
 
     /*Serial.print("C > PN5: ");
     for (uint8_t i = 0; i < (cmdlen - 1); i++) {
@@ -467,217 +862,314 @@ void DFRobot_PN532_IIC::writeCommand(uint8_t* cmd, uint8_t cmdlen) {
     Serial.println();*/
 }
 
-bool DFRobot_PN532_IIC::readAck(int x,long timeout ) {
-    uint8_t pn532ack[6];
-    pn532ack[0] = 0x00;
-    pn532ack[1] = 0x00;
-    pn532ack[2] = 0xFF;
-    pn532ack[3] = 0x00;
-    pn532ack[4] = 0xFF;
-    pn532ack[5] = 0x00;
-	timeout = 0;
-    if(_mode == 1){
-        if(!waitRemind())
-            return false;
-        Wire.requestFrom(I2C_ADDRESS,8);
-        Wire.read();
-        for(int i = 0; i < 6; i++){
-            delay(1);
-            receiveACK[i]= Wire.read();
-        }
-        if(!waitRemind() ) return false;
-        
-        Wire.requestFrom(I2C_ADDRESS,x-4);
-        Wire.read();
-        for(int i = 0; i < x - 6; i++){
-            delay(1);
-            receiveACK[6 + i] = Wire.read();
-        }
-        
-    }
-    else if(_mode == 0){
-        delay(30);
-        Wire.requestFrom(I2C_ADDRESS,8);
-        Wire.read();
-        for(int i = 0; i < 6; i++){
-            delay(1);
-            receiveACK[i]= Wire.read();
-        }
-        
-        delay(30);
-        Wire.requestFrom(I2C_ADDRESS,x-4);
-        Wire.read();
-        for(int i = 0; i < x - 6; i++){
-            delay(1);
-            receiveACK[6 + i] = Wire.read();
-        }
-    }
+/* Prebuilt frame (PN532_Frame, flash): no checksum calculation */
+void PN532_I2C::writeFrame_P(DFRobot_PN532 &nfc, const uint8_t *frame, uint8_t len) {
+    PN532_PROFILE_SCOPE(PN532_PROFILE_WRITE_COMMAND);
+    (void)nfc;
+    wakeUp();
+    writeRaw_P(frame,len);
+}
 
-    /*Serial.print("PN5 > C: ");
-    for (uint8_t i = 0; i < sizeof(receiveACK); i++) {
-      Serial.print(receiveACK[i],HEX);
-      Serial.print(" ");
-    }
-    Serial.println();*/
+/*
+    Read the ACK frame and the response frame of the last command.
+    x is the expected size of ACK + response (as before) and only used as read length hint:
+    the LEN field of the frame decides how many bytes are valid. If the frame is longer than
+    the hint, the PN532 is asked to send it again (NACK) and the whole frame is read.*/
+template <class ReadyStrategy>
+bool PN532_I2C::readAck(DFRobot_PN532 &nfc, int x, long timeout) {
+    PN532_PROFILE_SCOPE(PN532_PROFILE_READ_ACK);
 
-    if(strncmp((char *)pn532ack,(char *)receiveACK, 6)!=0){
-        return false ;
+    if(timeout <= 0)
+        timeout = nfc.responseTimeout;
+    nfc.status = DFRobot_PN532::STATUS_NO_RESPONSE;
+    if(!waitRemind<ReadyStrategy>(nfc,timeout)){
+        awake = false;            // No ACK: the command may have been sent while the PN532 was asleep
+        return false;
     }
-    return true;
-}
-DFRobot_PN532_IIC::DFRobot_PN532_IIC(uint8_t irq,uint8_t mode){
-    
-    _irq = irq;
-    pinMode(_irq, INPUT);
-    _mode = mode;
-}
-bool DFRobot_PN532_IIC::waitRemind(){
-    uint16_t timeout = 1000;
-    uint16_t timer = 0;
-     //digitalRead(_irq)
-    //return ret == 0;
-    //bool b = digitalRead(_irq);
-    //Serial.println(b);
-    while(digitalRead(_irq)!=0){
-        //Serial.print(digitalRead(_irq));
-    if (timeout != 0) {
-      timer += 10;
-      if (timer > timeout) {
+    nfc.status = DFRobot_PN532::STATUS_FRAME_ERROR;
+    if(!readFrame(nfc.receiveACK,6))
+        return false;
+    if(memcmp_P(nfc.receiveACK,pn532Ack,6) != 0)
+        return false;
+
+    uint8_t *frame = &nfc.receiveACK[6];
+    uint8_t maxFrameLen = (sizeof(nfc.receiveACK) - 6 < PN532_WIRE_BUFFSIZ - 1) ? sizeof(nfc.receiveACK) - 6 : PN532_WIRE_BUFFSIZ - 1;
+    uint8_t frameLen = (x - 6 < 7) ? 7 : x - 6;          // At least up to the first data byte
+    if(frameLen > maxFrameLen)
+        frameLen = maxFrameLen;
+    if(!waitRemind<ReadyStrategy>(nfc,timeout)){
+        writeRaw_P(pn532Ack,6);                           // Abort the running command
+        nfc.status = DFRobot_PN532::STATUS_NO_RESPONSE;
         return false;
-      }
     }
-    delay(10);
+    if(!readFrame(frame,frameLen))
+        return false;
+    if(frame[0] != PN532_PREAMBLE || frame[1] != PN532_STARTCODE1 || frame[2] != PN532_STARTCODE2)
+        return false;
+    if((uint8_t)(frame[3] + frame[4]) != 0)               // LCS
+        return false;
+    uint8_t neededLen = frame[3] + 6;                     // Preamble, start code, LEN, LCS, data, DCS
+    if(neededLen > maxFrameLen)
+        return false;
+    if(neededLen > frameLen){
+        PN532_PROFILE_RETRY(PN532_PROFILE_READ_ACK);
+        writeRaw_P(pn532Nack,6);
+        if(!waitRemind<ReadyStrategy>(nfc,timeout) || !readFrame(frame,neededLen))
+            return false;
     }
-    //Serial.print(digitalRead(_irq));
+    uint8_t sum = 0;
+    for(uint8_t i = 0; i <= frame[3]; i++)                // Data + DCS
+        sum += frame[5 + i];
+    if(sum != 0)
+        return false;
+    nfc.status = DFRobot_PN532::STATUS_OK;
     return true;
 }
-bool DFRobot_PN532_IIC::begin(void) {   //nfc Module initialization  
-    this->nfcPassword[0] = 0xff;
-    this->nfcPassword[1] = 0xff;
-    this->nfcPassword[2] = 0xff;
-    this->nfcPassword[3] = 0xff;
-    this->nfcPassword[4] = 0xff;
-    this->nfcPassword[5] = 0xff;
-    unsigned char cmdWrite[4];
-    cmdWrite[0] = COMMAND_SAMCONFIGURATION;
-    cmdWrite[1] = 0x01; // normal mode;
-    cmdWrite[2] = 0x14; // timeout 50ms * 20 = 1 second
-    cmdWrite[3] = 0x01; // use IRQ pin!
-    Wire.begin();
-    nfcEnable = true;
-    writeCommand(cmdWrite,4);
-    delay(10);
-    
-    if(readAck(14)!= 1){
-        
+
+/* One I2C read transaction: status byte followed by len bytes of the frame */
+bool PN532_I2C::readFrame(uint8_t *buffer, uint8_t len) {
+    if(Wire.requestFrom(I2C_ADDRESS,len + 1) != len + 1)
         return false;
-    }
-    return  ( receiveACK[12] == 0x15);
+    if((Wire.read() & 0x01) == 0)
+        return false;
+    for(uint8_t i = 0; i < len; i++)
+        buffer[i] = Wire.read();
+    return true;
 }
-#ifdef ESP_PLATFORM
-bool DFRobot_PN532_UART::begin(HardwareSerial *serial, int rx, int tx)
-{   this->uartTimeout = 1000;
-    this->_serial = serial;
-    this->_serial->begin(115200,rx,tx);
 
-#else
-bool DFRobot_PN532_UART::begin(HardwareSerial *serial)
-{   this->uartTimeout = 1000;
-    this->_serial = serial;
-    this->_serial->begin(115200);
-#endif
-    this->nfcPassword[0] = 0xff;
-    this->nfcPassword[1] = 0xff;
-    this->nfcPassword[2] = 0xff;
-    this->nfcPassword[3] = 0xff;
-    this->nfcPassword[4] = 0xff;
-    this->nfcPassword[5] = 0xff;
-    memset(this->receiveACK,0,35);
-    memset(this->blockData,0,16);
-    memset(this->nfcUid,0,4);
-    unsigned char wake[24] = {0x55, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
-           0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x03, 0xfd, 0xd4, 0x14, 0x01, 0x17, 0x00};//Wake up NFC module
-    for(int i = 0; i < 24; i++)
-    {
-        this->_serial->write(wake[i]);
+void PN532_I2C::writeRaw_P(const uint8_t *data, uint8_t len) {
+    Wire.beginTransmission(I2C_ADDRESS);
+    for(uint8_t i = 0; i < len; i++)
+        Wire.write(pgm_read_byte(&data[i]));
+    if(Wire.endTransmission() != 0)
+        awake = false;
+}
+
+/* Wait until the PN532 has a frame ready: IRQ line (interrupt mode) or status byte (polling mode) */
+template <class ReadyStrategy>
+bool PN532_I2C::waitRemind(DFRobot_PN532 &nfc, long timeout){
+    unsigned long start = millis();
+    do {
+        if(ReadyStrategy::useIrq(nfc)){
+            if(digitalRead(nfc._irq) == 0)
+                return true;
+        }
+        else{
+            Wire.requestFrom(I2C_ADDRESS,1);
+            if(Wire.read() & 0x01)
+                return true;
+        }
+    } while((long)(millis() - start) < timeout);
+    return false;
+}
+
+/*
+    Send commands to the chip through the serial port (HSU)*/
+
+bool PN532_HSU::begin(DFRobot_PN532 &nfc) {
+    if(this->serial == NULL)
+        return false;
+    memset(nfc.receiveACK,0,sizeof(nfc.receiveACK));
+    memset(nfc.blockData,0,16);
+    memset(nfc.nfcUid,0,4);
+    /* Wake up NFC module: 0x55 0x55 and a long preamble, the SAMConfiguration frame follows */
+    this->serial->write((byte)0x55);
+    this->serial->write((byte)0x55);
+    for(uint8_t i = 0; i < 14; i++)
+        this->serial->write((byte)0x00);
 #if defined(ARDUINO) && ARDUINO >= 100
 #ifndef ESP_PLATFORM
-        this->_serial->flush();// Complete the transmission of outgoing serial data
+    this->serial->flush();// Complete the transmission of outgoing serial data
 #endif
 #endif
+    dropInput();
+    return true;
+}
+
+/*
+    Read the ACK frame and the response frame of the last command from the byte stream.
+    Both are normalized into receiveACK like over I2C (ACK in [0..5], response from [6]),
+    x is not needed: the LEN field of the frame decides. Frames received before the ACK
+    (late response of an aborted command) are skipped.
+    HSU: the ready strategy is not used, the received bytes are polled until the deadline. */
+template <class ReadyStrategy>
+bool PN532_HSU::readAck(DFRobot_PN532 &nfc, int x, long timeout)
+{   PN532_PROFILE_SCOPE(PN532_PROFILE_READ_ACK);
+    (void)x;
+    if(timeout <= 0)
+        timeout = nfc.responseTimeout;
+    uint8_t *frame = &nfc.receiveACK[6];
+    int8_t result;
+    unsigned long start = millis();
+    do {
+        result = readFrame(frame,sizeof(nfc.receiveACK) - 6,start,timeout);
+    } while(result == HSU_FRAME);
+    if(result != HSU_ACK){
+        nfc.status = (result == HSU_TIMEOUT) ? DFRobot_PN532::STATUS_NO_RESPONSE : DFRobot_PN532::STATUS_FRAME_ERROR;
+        return false;
     }
-    if(!this->readAck(15)){
-    this->nfcEnable = false;
-    return false;
+    memcpy_P(nfc.receiveACK,pn532Ack,6);
+
+    result = readFrame(frame,sizeof(nfc.receiveACK) - 6,millis(),timeout);
+    if(result == HSU_TIMEOUT){
+        writeRaw_P(pn532Ack,6);                           // Abort the running command
+        nfc.status = DFRobot_PN532::STATUS_NO_RESPONSE;
+        return false;
     }
-    this->nfcEnable = true;
-    return  (receiveACK[12] == 0x15);;
-}
-bool DFRobot_PN532_UART::readAck(int x, long timeout) //Read the data from the serial port
-{   uint8_t pn532ack[6];
-    pn532ack[0] = 0x00;
-    pn532ack[1] = 0x00;
-    pn532ack[2] = 0xFF;
-    pn532ack[3] = 0x00;
-    pn532ack[4] = 0xFF;
-    pn532ack[5] = 0x00;
-	timeout = 0;
-    delay(100);
-        if(this->_serial->available()){
-            
-        for(int i = 0; i<=x ;i++){
-            receiveACK[i] = _serial->read();
+    if(result != HSU_FRAME || frame[5] != PN532TOHOST){   // Checksum error or error frame (TFI 0x7F)
+        nfc.status = (result == HSU_FRAME) ? DFRobot_PN532::STATUS_COMMAND_ERROR : DFRobot_PN532::STATUS_FRAME_ERROR;
+        return false;
+    }
+    nfc.status = DFRobot_PN532::STATUS_OK;
+    return true;
+}
+
+/*
+    Streaming frame decoder: synchronizes on the start code 00 FF, checks LCS and DCS and
+    stores an information frame as 00 00 FF LEN LCS data DCS 00 (maxLen bytes room).
+    Returns as soon as one frame is complete, HSU_TIMEOUT at the deadline start + timeout. */
+int8_t PN532_HSU::readFrame(uint8_t *frame, uint8_t maxLen, unsigned long start, long timeout)
+{
+    uint8_t state = 0;
+    uint8_t len = 0;
+    uint8_t pos = 0;
+    uint8_t sum = 0;
+    while(true){
+        if(this->serial->available() <= 0){
+            if((long)(millis() - start) >= timeout)
+                return HSU_TIMEOUT;
+            continue;
         }
+        uint8_t c = this->serial->read();
+        switch(state){
+            case 0:                                   // Preamble / start code 1
+                if(c == PN532_STARTCODE1)
+                    state = 1;
+                break;
+            case 1:                                   // Start code 2 (more 00 bytes are allowed)
+                if(c == PN532_STARTCODE2)
+                    state = 2;
+                else if(c != PN532_STARTCODE1)
+                    state = 0;
+                break;
+            case 2:                                   // LEN
+                len = c;
+                state = 3;
+                break;
+            case 3:                                   // LCS (the postamble is skipped by the next sync)
+                if(len == 0x00 && c == 0xFF)
+                    return HSU_ACK;
+                if((uint8_t)(len + c) != 0 || len + 7 > maxLen)
+                    return HSU_BAD_FRAME;
+                frame[0] = PN532_PREAMBLE;
+                frame[1] = PN532_STARTCODE1;
+                frame[2] = PN532_STARTCODE2;
+                frame[3] = len;
+                frame[4] = c;
+                pos = 5;
+                sum = 0;
+                state = 4;
+                break;
+            default:                                  // Data (TFI..PD) and DCS
+                frame[pos++] = c;
+                sum += c;
+                if(pos == len + 6){
+                    frame[pos] = PN532_POSTAMBLE;
+                    return (sum == 0) ? HSU_FRAME : HSU_BAD_FRAME;
+                }
+                break;
         }
-        //for(int i= 0 ; i<32 ;i++){
-        //Serial.print(receiveACK[i],HEX);
-        //Serial.print(" ");
-    //}
-        if(strncmp((char *)pn532ack,(char *)receiveACK, 6)!=0){
-        return false ;
     }
-    return true;
-            
 }
 
-void DFRobot_PN532_UART::writeCommand(uint8_t *command_data, uint8_t bytes)
+/* Drop the bytes already received (e.g. a late response) before a new command, no waiting */
+void PN532_HSU::dropInput(void)
+{
+    for(int n = this->serial->available(); n > 0; n--)
+        this->serial->read();
+}
+
+void PN532_HSU::writeRaw_P(const uint8_t *data, uint8_t len)
+{
+    for(uint8_t i = 0; i < len; i++)
+        this->serial->write(pgm_read_byte(&data[i]));
+}
+
+void PN532_HSU::writeCommand(DFRobot_PN532 &nfc, const uint8_t *command_data, uint8_t bytes)
 {   
-    
-    long timeout = millis();
-    if(this->_serial == NULL)
+    PN532_PROFILE_SCOPE(PN532_PROFILE_WRITE_COMMAND);
+    (void)nfc;
+    if(this->serial == NULL)
         return;
-    char residual ;
-    while(this->_serial->available()){
-        residual = this->_serial->read();
-        if(((millis() - timeout) >= this->uartTimeout) && this->_serial->available())
-            return ;
-    }
+    dropInput();
     uint8_t checksum;
     bytes++;
-    delay(2);     // Delay for random time to wake up NFC module
-    // I2C START
     checksum = PN532_PREAMBLE + PN532_STARTCODE1 + PN532_STARTCODE2;
-    this->_serial->write((byte)PN532_PREAMBLE);
-    this->_serial->write((byte)PN532_STARTCODE1);
-    this->_serial->write((byte)PN532_STARTCODE2);
+    this->serial->write((byte)PN532_PREAMBLE);
+    this->serial->write((byte)PN532_STARTCODE1);
+    this->serial->write((byte)PN532_STARTCODE2);
 
-    this->_serial->write(bytes);
-    this->_serial->write(~bytes + 1);
+    this->serial->write(bytes);
+    this->serial->write(~bytes + 1);
 
-    this->_serial->write(HOSTTOPN532);
+    this->serial->write(HOSTTOPN532);
     checksum += HOSTTOPN532;
 
     for (uint8_t i = 0; i < bytes-1; i++) {
-       this->_serial->write(command_data[i]);
+       this->serial->write(command_data[i]);
        checksum += command_data[i];
     }
 
-    this->_serial->write((byte)~checksum);
-    this->_serial->write((byte)PN532_POSTAMBLE);
-#if defined(ARDUINO) && ARDUINO >= 100
-#ifndef ESP_PLATFORM
-    this->_serial->flush();/* Complete the transmission of outgoing serial data*/
-#endif
+    this->serial->write((byte)~checksum);
+    this->serial->write((byte)PN532_POSTAMBLE);
+}
+
+/* Prebuilt frame (PN532_Frame, flash): no checksum calculation */
+void PN532_HSU::writeFrame_P(DFRobot_PN532 &nfc, const uint8_t *frame, uint8_t len)
+{
+    PN532_PROFILE_SCOPE(PN532_PROFILE_WRITE_COMMAND);
+    (void)nfc;
+    if(this->serial == NULL)
+        return;
+    dropInput();
+    writeRaw_P(frame,len);
+}
+
+/*
+    SetSerialBaudRate: the PN532 answers at the old rate and changes it after the ACK of the host,
+    then the serial port of the host follows (UM0701-02, 7.2.5). */
+bool PN532_HSU::setBaudRate(DFRobot_PN532 &nfc, uint32_t baud)
+{
+    uint8_t br = 0;
+    while(br < sizeof(hsuBaudRates)/sizeof(hsuBaudRates[0]) && pgm_read_dword(&hsuBaudRates[br]) != baud)
+        br++;
+    if(this->serial == NULL || br == sizeof(hsuBaudRates)/sizeof(hsuBaudRates[0])){
+        nfc.status = DFRobot_PN532::STATUS_COMMAND_ERROR;
+        return false;
+    }
+    uint8_t cmdBaud[2];
+    cmdBaud[0] = COMMAND_SETSERIALBAUDRATE;
+    cmdBaud[1] = br;
+    writeCommand(nfc,cmdBaud,2);
+    if(!readAck<PN532_Polling>(nfc,14,0))
+        return false;
+    if(nfc.receiveACK[12] != COMMAND_SETSERIALBAUDRATE + 1){
+        nfc.status = DFRobot_PN532::STATUS_COMMAND_ERROR;
+        return false;
+    }
+    writeRaw_P(pn532Ack,6);
+    this->serial->flush();      // The ACK has to be sent completely at the old rate
+    delay(1);                   // PN532 needs 200 us to switch
+#ifdef ESP_PLATFORM
+    this->serial->updateBaudRate(baud);
+#else
+    this->serial->begin(baud);
 #endif
-    
-}
\ No newline at end of file
+    return true;
+}
+
+/* Drivers used by the compatibility classes and the THMS bridge; other combinations can be added here */
+template class PN532<PN532_I2C, PN532_Polling>;
+template class PN532<PN532_I2C, PN532_Irq>;
+template class PN532<PN532_I2C, PN532_RuntimeMode>;
+template class PN532<PN532_HSU, PN532_Polling>;
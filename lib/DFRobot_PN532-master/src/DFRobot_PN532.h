@@ -27,22 +27,95 @@
 #define COMMAND_SAMCONFIGURATION            (0x14)//SAM Configuration Commands
 #define COMMAND_INLISTPASSIVETARGET         (0x4A)
 #define COMMAND_INDATAEXCHANGE              (0x40)
+#define COMMAND_RFCONFIGURATION             (0x32)
+#define COMMAND_SETSERIALBAUDRATE           (0x10)
 #define I2C_ADDRESS                    (0x48 >> 1)//Device address
 #define MIFARE_ISO14443A                    (0x00)
+#define PN532_PASSIVE_ACTIVATION_RETRIES    (0x02)//MxRtyPassiveActivation (0xFF = wait for a card forever)
+#define PN532_MAX_TARGETS                   (2   )//InListPassiveTarget: the PN532 handles at most two targets
+#define PN532_RESPONSE_TIMEOUT_MS           (1000)//Default time to wait for the ACK/response of the PN532
+#define PN532_I2C_WAKEUP_MS                 (2   )//Time the PN532 needs after an I2C access woke it up from power down
+#define PN532_HSU_BAUD                      (115200)//Baud rate of the PN532 HSU after power on
 // CARD Commands
 #define CARD_CMD_READING                     (0x30)//Command to read data
+#define CARD_CMD_FAST_READING                (0x3A)//Command to read a page range of NTAG21x cards
 #define CARD_CMD_WRITEINGTOMIFARECLASSIC     (0xA0)//Command to write a card of type MifareClassic
 #define CARD_CMD_WRITEINGTONTGE              (0xA2)//Command for writing NTGE cards
 #define CARD_CMD_WRITEINGTOULTRALIGHT        (0xA2)// Command for writing ultralight cards
 #define CARD_CMD_AUTHENTICATION_A            (0x60)//The command to authenticate with the A-block password
 #define CARD_CMD_AUTHENTICATION_B            (0x61)//The command to authenticate with the B-block password
+#define CARD_CMD_GET_VERSION                 (0x60)//Command to read the version (vendor, type, storage size) of NTAG21x/Ultralight EV1 cards
 
+#if defined(BUFFER_LENGTH)
+#define PN532_WIRE_BUFFSIZ                   BUFFER_LENGTH//Receive buffer of the Wire library
+#elif defined(I2C_BUFFER_LENGTH)
+#define PN532_WIRE_BUFFSIZ                   I2C_BUFFER_LENGTH
+#else
+#define PN532_WIRE_BUFFSIZ                   (32  )
+#endif
+#define NTAG_PAGES_PER_READ                  (4   )//Pages returned by one READ command
+// Pages per FAST_READ: response frame (16 + 4*n bytes incl. ACK) has to fit into receiveACK,
+// the I2C read (status byte + frame without ACK = 12 + 4*n bytes) into the Wire buffer.
+#define NTAG_FAST_READ_MAX_PAGES             ((((PN532_PACKBUFFSIZ) - 16)/4 < ((PN532_WIRE_BUFFSIZ) - 12)/4) ? \
+                                              ((PN532_PACKBUFFSIZ) - 16)/4 : ((PN532_WIRE_BUFFSIZ) - 12)/4)
+// InListPassiveTarget response frame for n ISO14443A targets with 7 byte UID (without ACK):
+// preamble, start code, LEN, LCS, D5 4B, NbTg, n*(Tg, ATQA, SAK, NFCIDLength, UID), DCS, postamble
+#define PN532_INLIST_FRAME_SIZE(n)           (10 + 12*(n))
+// Targets per InListPassiveTarget over I2C: the whole frame has to fit into one Wire read (status byte + frame).
+// With 1, scanTargets/selectTarget list the tags one after the other (one InListPassiveTarget per tag).
+#define PN532_IIC_MAX_TARGETS                (((PN532_WIRE_BUFFSIZ) - 1 >= PN532_INLIST_FRAME_SIZE(2)) ? 2 : 1)
+
+// Profiling hooks around the bus accesses (point: ePN532ProfilePoint_t), empty by default.
+// With -DPN532_PROFILING the driver calls pn532ProfileBegin/End/Retry(), which the application
+// implements. The macros can also be given directly as build flags.
+typedef enum{
+    PN532_PROFILE_SCAN = 0,          /**<scan() / scanTargets()*/
+    PN532_PROFILE_READ_ACK,          /**<readAck() (retry: frame read again after NACK)*/
+    PN532_PROFILE_WRITE_COMMAND      /**<writeCommand() / writeFrame_P()*/
+}ePN532ProfilePoint_t;
+#ifdef PN532_PROFILING
+void pn532ProfileBegin(uint8_t point);
+void pn532ProfileEnd(uint8_t point);
+void pn532ProfileRetry(uint8_t point);
+#ifndef PN532_PROFILE_BEGIN
+#define PN532_PROFILE_BEGIN(point)           pn532ProfileBegin(point)
+#endif
+#ifndef PN532_PROFILE_END
+#define PN532_PROFILE_END(point)             pn532ProfileEnd(point)
+#endif
+#ifndef PN532_PROFILE_RETRY
+#define PN532_PROFILE_RETRY(point)           pn532ProfileRetry(point)
+#endif
+#endif
+#ifndef PN532_PROFILE_BEGIN
+#define PN532_PROFILE_BEGIN(point)
+#endif
+#ifndef PN532_PROFILE_END
+#define PN532_PROFILE_END(point)
+#endif
+#ifndef PN532_PROFILE_RETRY
+#define PN532_PROFILE_RETRY(point)
+#endif
 
 
 
 class DFRobot_PN532
 {  
 public: 
+  typedef enum{
+      CARD_TYPE_UNKNOWN = 0,          /**<No card or no answer to the identification*/
+      CARD_TYPE_MIFARE_CLASSIC_1K,
+      CARD_TYPE_MIFARE_CLASSIC_4K,
+      CARD_TYPE_ULTRALIGHT,           /**<MIFARE Ultralight (no GET_VERSION)*/
+      CARD_TYPE_ULTRALIGHT_EV1_48,    /**<MF0UL11*/
+      CARD_TYPE_ULTRALIGHT_EV1_128,   /**<MF0UL21*/
+      CARD_TYPE_NTAG210,
+      CARD_TYPE_NTAG212,
+      CARD_TYPE_NTAG213,
+      CARD_TYPE_NTAG215,
+      CARD_TYPE_NTAG216,
+      CARD_TYPE_COUNT
+  }eCardType_t;
   typedef struct{
       uint8_t uidlenght;/**<The length of the uid*/
       int size;            
@@ -52,12 +125,214 @@ public:
       uint8_t sectorSize; /**<Sector size*/
       uint8_t SAK;  /**<SAK code*/
       uint8_t AQTA[2];  /**<AQTA*/
-      char RFTechnology[25]={0};/**<Radio frequency information*/
-      char Manufacturer[6]={0};/**<Vendor string*/
       uint8_t uid[7];    /**<Uid content*/
-      char cardType[30]={0};/**<The chip type*/
+      eCardType_t type;  /**<The chip type (ISO/IEC14443-3 Type A, NXP), see cardTypeName()*/
   }sCard_t;
+  typedef enum{
+      STATUS_OK = 0,
+      STATUS_NO_RESPONSE,             /**<PN532 did not signal ready in time*/
+      STATUS_FRAME_ERROR,             /**<No ACK, bad LCS/DCS, short read or unexpected response (host link)*/
+      STATUS_NO_TARGET,               /**<Tag not in the field (scan found no or only other tags)*/
+      STATUS_RF_TIMEOUT,              /**<PN532 error 0x01: the tag did not answer*/
+      STATUS_RF_ERROR,                /**<PN532 error 0x02..0x07: CRC, parity, bit count, framing, collision, buffer*/
+      STATUS_COMMAND_ERROR,           /**<Other PN532 error (e.g. 0x27 command not acceptable) or invalid call*/
+      STATUS_COUNT
+  }eStatus_t;
+  typedef struct{
+      uint8_t tg;         /**<Logical target number assigned by the PN532 (used for InDataExchange)*/
+      uint8_t ATQA[2];    /**<ATQA*/
+      uint8_t SAK;        /**<SAK code*/
+      uint8_t uid[7];     /**<Uid content*/
+      uint8_t uidLength;  /**<Length of uid (4 or 7)*/
+  }sTarget_t;
 public: 
+   /*!
+    * @fn endSession
+    * @brief Leave the session. Every page operation selects the tag again (default behaviour).
+    */
+   void  endSession(void);
+
+   /*!
+    * @fn uidToHex
+    * @brief Format a UID as lowercase hex (e.g. "04a1b2c3") without String/heap.
+    * @param uid UID of the tag.
+    * @param uidLength Length of the UID (at most 7).
+    * @param hex The buffer of the text, at least 2*uidLength+1 bytes.
+    * @return Number of characters (without the terminating 0)
+    */
+   static uint8_t uidToHex(const uint8_t *uid, uint8_t uidLength, char *hex);
+
+   /*!
+    * @fn cardTypeName
+    * @brief Name of a card type (e.g. "NTAG 213") for printing.
+    */
+   static const __FlashStringHelper * cardTypeName(eCardType_t type);
+
+   /*!
+    * @fn isNTAG
+    * @brief true for NTAG210/212/213/215/216.
+    */
+   static bool isNTAG(eCardType_t type);
+
+   /*!
+    * @fn isUltralight
+    * @brief true for MIFARE Ultralight and Ultralight EV1.
+    */
+   static bool isUltralight(eCardType_t type);
+
+   /*!
+    * @fn lastStatus
+    * @brief Why the last scan/page operation failed (STATUS_OK after success).
+    */
+   eStatus_t lastStatus(void) const { return status; }
+
+   /*!
+    * @fn statusName
+    * @brief Name of a status (e.g. "RF timeout") for printing.
+    */
+   static const __FlashStringHelper * statusName(eStatus_t status);
+
+   /*!
+    * @fn setResponseTimeout
+    * @brief Time readAck waits for the PN532 (default PN532_RESPONSE_TIMEOUT_MS).
+    */
+   void  setResponseTimeout(uint16_t timeoutMs) { responseTimeout = timeoutMs; }
+
+     
+
+   uint8_t receiveACK[PN532_PACKBUFFSIZ];    
+   uint8_t nfcPassword[6]; 
+   uint8_t nfcUid[4]; 
+   uint8_t targetUid[7];      /**<Full UID of the tag found by the last scan*/
+   uint8_t targetUidLength;   /**<Length of targetUid (4 or 7)*/
+   sTarget_t targets[PN532_MAX_TARGETS];  /**<Tags found by the last scanTargets*/
+   uint8_t targetCount;       /**<Number of valid entries in targets*/
+   uint8_t maxTargetsPerScan = 1;  /**<Targets per InListPassiveTarget the transport can receive*/
+   uint8_t blockData[16];
+   bool nfcEnable;
+   long uartTimeout; 
+   uint8_t _irq;
+   uint8_t _mode;
+     
+protected:
+   DFRobot_PN532() {}
+   bool  checkDCS(int x);
+   void  targetLost(void);
+   bool  exchangeOk(void);
+   bool sessionActive = false;
+   bool targetSelected = false;
+   uint8_t sessionUid[7];
+   uint8_t sessionUidLength = 0;
+   uint8_t targetNumber = 1;  /* Tg of the selected tag for InDataExchange */
+   uint8_t activeUid[7];      /* Tag still active from the last single-target InListPassiveTarget */
+   uint8_t activeUidLength = 0;  /* 0: none (lost, or listed otherwise) */
+   uint8_t activeTg = 0;
+   eStatus_t status = STATUS_OK;
+   uint16_t responseTimeout = PN532_RESPONSE_TIMEOUT_MS;
+   friend class PN532_I2C;
+   friend class PN532_HSU;
+      
+};
+
+/*
+    Ready strategies: how readAck learns that the PN532 has a frame ready.
+    The strategy is a template argument of PN532, so the unused branch is removed by the compiler. */
+struct PN532_Polling           /* I2C: status byte of the PN532 */
+{
+   static bool useIrq(const DFRobot_PN532 &nfc) { (void)nfc; return false; }
+};
+struct PN532_Irq               /* IRQ line (pin _irq), low = frame ready */
+{
+   static bool useIrq(const DFRobot_PN532 &nfc) { (void)nfc; return true; }
+};
+struct PN532_RuntimeMode       /* _mode (1 = IRQ line, else polling) chosen at runtime, see DFRobot_PN532_IIC */
+{
+   static bool useIrq(const DFRobot_PN532 &nfc) { return nfc._mode == 1; }
+};
+
+/*
+    Complete information frame of a fixed command: LEN/LCS and DCS are computed by the compiler
+    and the frame is stored in flash, e.g. PN532_Frame<COMMAND_INLISTPASSIVETARGET, 1, MIFARE_ISO14443A>. */
+constexpr uint8_t pn532Sum() { return 0; }
+template <class... Bytes>
+constexpr uint8_t pn532Sum(uint8_t first, Bytes... rest) { return (uint8_t)(first + pn532Sum(rest...)); }
+
+template <uint8_t... Data>
+struct PN532_Frame
+{
+   static const uint8_t length = sizeof...(Data) + 8;
+   static const uint8_t data[sizeof...(Data) + 8];
+};
+template <uint8_t... Data>
+const uint8_t PN532_Frame<Data...>::data[sizeof...(Data) + 8] PROGMEM = {
+    PN532_PREAMBLE, PN532_STARTCODE1, PN532_STARTCODE2,
+    (uint8_t)(sizeof...(Data) + 1), (uint8_t)(0x100 - (sizeof...(Data) + 1)),   /* LEN, LCS */
+    HOSTTOPN532, Data...,
+    (uint8_t)(0x100 - (uint8_t)(HOSTTOPN532 + pn532Sum(Data...))),                /* DCS */
+    PN532_POSTAMBLE
+};
+
+/*
+    Transports: the host link to the PN532. They fill nfc.receiveACK and nfc.status. */
+class PN532_I2C
+{
+public:
+   static const uint8_t maxTargets = PN532_IIC_MAX_TARGETS;  /**<The response for two targets does not fit into the 32 byte AVR Wire buffer*/
+   bool begin(DFRobot_PN532 &nfc);
+   void writeCommand(DFRobot_PN532 &nfc, const uint8_t *cmd, uint8_t cmdlen);
+   void writeFrame_P(DFRobot_PN532 &nfc, const uint8_t *frame, uint8_t len);
+   template <class ReadyStrategy> bool readAck(DFRobot_PN532 &nfc, int x, long timeout);
+   bool setBaudRate(DFRobot_PN532 &nfc, uint32_t baud) { (void)baud; nfc.status = DFRobot_PN532::STATUS_COMMAND_ERROR; return false; }
+private:
+   bool awake = false;             /**<false: the next command first waits PN532_I2C_WAKEUP_MS (after begin() or a lost command)*/
+   void wakeUp(void);
+   template <class ReadyStrategy> bool waitRemind(DFRobot_PN532 &nfc, long timeout);
+   bool readFrame(uint8_t *buffer, uint8_t len);
+   void writeRaw_P(const uint8_t *data, uint8_t len);
+};
+
+class PN532_HSU
+{
+public:
+   static const uint8_t maxTargets = PN532_MAX_TARGETS;
+   HardwareSerial *serial = NULL;  /**<Serial port, opened with PN532_HSU_BAUD before begin()*/
+   bool begin(DFRobot_PN532 &nfc);
+   void writeCommand(DFRobot_PN532 &nfc, const uint8_t *cmd, uint8_t cmdlen);
+   void writeFrame_P(DFRobot_PN532 &nfc, const uint8_t *frame, uint8_t len);
+   template <class ReadyStrategy> bool readAck(DFRobot_PN532 &nfc, int x, long timeout);
+   bool setBaudRate(DFRobot_PN532 &nfc, uint32_t baud);
+private:
+   enum { HSU_TIMEOUT = -2, HSU_BAD_FRAME = -1, HSU_ACK = 0, HSU_FRAME = 1 };   /* Result of readFrame */
+   int8_t readFrame(uint8_t *frame, uint8_t maxLen, unsigned long start, long timeout);
+   void dropInput(void);
+   void writeRaw_P(const uint8_t *data, uint8_t len);
+};
+
+/*
+    PN532 driver with transport and ready strategy chosen at compile time (no virtual calls),
+    e.g. PN532<PN532_I2C, PN532_Irq> nfc(2);
+    Instantiated in DFRobot_PN532.cpp for <PN532_I2C, PN532_Polling/PN532_Irq/PN532_RuntimeMode>
+    and <PN532_HSU, PN532_Polling>; unused instances are removed by the linker. */
+template <class Transport, class ReadyStrategy>
+class PN532 : public DFRobot_PN532
+{
+public:
+  /*!
+   * @fn PN532
+   * @brief constructor
+   * @param irq interrupt pin (only used with PN532_Irq or PN532_RuntimeMode)
+   */
+   PN532(uint8_t irq = 0xFF);
+
+  /*!
+   * @fn begin
+   * @brief Initializes the NFC chip
+   * @return Boolean type, the result of operation
+   * @retval true Initialization succeeded
+   * @retval false Initialization failed
+   */
+   bool begin(void);
+
    /*!
     * @fn readData
     * @brief Read a block from a MIFARE Classic NFC smart card/tag (16 bytes each block).
@@ -69,6 +344,16 @@ public:
     */   
    uint8_t readData(uint8_t *buffer,uint8_t block);
 
+   /*!
+    * @fn readBlock
+    * @brief Read a block from a MIFARE Classic NFC smart card/tag (16 bytes each block)
+    *        without String/heap. Authenticates with nfcPassword (key A).
+    * @param buffer The buffer of the read data, at least 16 bytes.
+    * @param block The number of the block to read from.
+    * @return STATUS_OK or why the block was not read (STATUS_COMMAND_ERROR: authentication failed)
+    */
+   eStatus_t readBlock(uint8_t *buffer,uint8_t block);
+
    /*!
     * @fn readData
     * @brief Read a byte from a specified block of a MIFARE Classic NFC smart card/tag.
@@ -99,20 +384,84 @@ public:
    /*!
     * @fn scan
     * @brief Scan to determine whether there is a NFC smart card/tag with the specified UID.
+    *        Wrapper of scan(const uint8_t *, uint8_t): the full UID or its first 4 bytes
+    *        as lowercase hex (like readUid()) are accepted.
     * @param nfcuid UID of the NFC card.
     * @return Boolean type, the result of operation
     * @retval true Finds a card with a specific UID
     * @retval false The card with a specific UID was not found
     */   
-   bool  scan(String nfcuid);
+   bool  scan(const String &nfcuid);
+
+   /*!
+    * @fn scan
+    * @brief Scan to determine whether there is a NFC smart card/tag with the specified UID.
+    *        All bytes of the UID are compared, no String/heap is used.
+    * @param uid UID of the tag.
+    * @param uidLength Length of the UID (4 or 7).
+    * @return Boolean type, the result of operation
+    * @retval true Finds a card with this UID
+    * @retval false No card or another card (lastStatus() is STATUS_NO_TARGET)
+    */
+   bool  scan(const uint8_t *uid, uint8_t uidLength);
+
+   /*!
+    * @fn scanTargets
+    * @brief List up to maxTargets ISO14443A tags with one InListPassiveTarget command.
+    *        The result is stored in targets[0..targetCount-1]; the first target is also
+    *        stored in targetUid like scan() does. If the transport receives only one target per
+    *        command (the response for two targets does not fit into the 32 byte AVR Wire buffer),
+    *        the tags are listed one after the other: the active tag does not answer the next
+    *        InListPassiveTarget (ISO14443-3: back to IDLE), so another tag in the field does.
+    *        If the same tag answers again, there is no further tag. Neither InRelease nor an RF
+    *        field reset is used, so a tag that is measuring keeps its energy. Only the last
+    *        listed tag stays active; the others get tg 0 and are selected by UID when used.
+    * @param maxTargets Number of tags to list (1 or 2).
+    * @return Number of tags found (0 = no tag)
+    */
+   uint8_t scanTargets(uint8_t maxTargets);
+
+   /*!
+    * @fn beginSession
+    * @brief Select the tag once and keep it selected for the following page operations
+    *        (readNTAG, readNTAGPages, fastReadNTAG, writeNTAG, readUltralight, writeUltralight).
+    *        Inside a session the tag is only selected again after an RF or timeout error,
+    *        and only the tag selected first is accepted.
+    * @return Boolean type, the result of operation
+    * @retval true Tag selected
+    * @retval false No tag (page operations will try to select it again)
+    */
+   bool  beginSession(void);
+
+   /*!
+    * @fn beginSession
+    * @brief Like beginSession(void), but only the tag with the given UID is accepted.
+    *        With several tags in the field, the tag is addressed by its target number.
+    * @param uid UID of the tag.
+    * @param uidLength Length of the UID (4 or 7).
+    * @return Boolean type, the result of operation
+    * @retval true Tag selected
+    * @retval false Tag with this UID not found
+    */
+   bool  beginSession(const uint8_t *uid, uint8_t uidLength);
 
    /*!
     * @fn readUid
     * @brief Obtain the UID of the card .
-    * @return UID of the card.
+    *        Wrapper of readUid(uint8_t *, uint8_t *): the first 4 bytes as lowercase hex.
+    * @return UID of the card, "no card!" or "wake up error!".
     */  
    String  readUid();
 
+   /*!
+    * @fn readUid
+    * @brief Obtain the full UID of the card without String/heap.
+    * @param uid The buffer of the UID, at least 7 bytes.
+    * @param uidLength Length of the UID (4 or 7), 0 if no card was found.
+    * @return STATUS_OK or why no UID was read
+    */
+   eStatus_t readUid(uint8_t *uid, uint8_t *uidLength);
+
    /*!
     * @fn writeData
     * @brief Write a block to a MIFARE Classic NFC smart card/tag..
@@ -152,6 +501,29 @@ public:
     */
    uint8_t readNTAG(uint8_t *buffer,uint8_t block);
 
+   /*!
+    * @fn readNTAGPages
+    * @brief Read four consecutive pages (16 bytes) from a NTAG with one READ command.
+    * @param buffer The buffer of the read data, at least 16 bytes.
+    * @param block The number of the first page to read from.
+    * @return Status code. 
+    * @retval 1 successfully read data
+    * @retval -1 Failed to read data
+    */
+   uint8_t readNTAGPages(uint8_t *buffer,uint8_t block);
+
+   /*!
+    * @fn fastReadNTAG
+    * @brief Read the pages startPage..endPage from a NTAG21x with one FAST_READ command.
+    * @param buffer The buffer of the read data, at least 4*(endPage-startPage+1) bytes.
+    * @param startPage The number of the first page to read from.
+    * @param endPage The number of the last page to read from (at most NTAG_FAST_READ_MAX_PAGES pages).
+    * @return Status code. 
+    * @retval 1 successfully read data
+    * @retval -1 Failed to read data (e.g. FAST_READ not supported by the tag)
+    */
+   uint8_t fastReadNTAG(uint8_t *buffer,uint8_t startPage,uint8_t endPage);
+
    /*!
     * @fn writeNTAG
     * @brief Write a page to a NTAG.
@@ -165,32 +537,64 @@ public:
 
    /*!
     * @fn readData
-    * @brief Read the basic information of a NFC smart card/tag. 
+    * @brief Read the basic information of a NFC smart card/tag (one scan, for type 2 tags one GET_VERSION).
     * @return Info. of the sCard_t.
     */
    sCard_t getInformation();
-     
 
-   uint8_t receiveACK[35];    
-   uint8_t nfcPassword[6]; 
-   uint8_t nfcUid[4]; 
-   uint8_t blockData[16];
-   bool nfcEnable;
-   long uartTimeout; 
-   uint8_t _irq;
-   uint8_t _mode;
-     
+   /*!
+    * @fn getVersion
+    * @brief Read the GET_VERSION response (8 bytes) of a NTAG21x/Ultralight EV1 tag.
+    * @param version The buffer of the version, at least 8 bytes.
+    * @return Status code. 
+    * @retval 1 successfully read
+    * @retval 0 The tag refused the command (e.g. MIFARE Ultralight); it has to be selected again
+    * @retval -1 No answer
+    */
+   uint8_t getVersion(uint8_t *version);
+
+   /*!
+    * @fn identifyTarget
+    * @brief Identify a tag of the last scanTargets() without listing it again:
+    *        ATQA/SAK, for type 2 tags (ATQA 0x0044) one GET_VERSION. A tag that is not
+    *        active any more after listing one by one (tg 0) is selected by its UID first.
+    * @param index Index in targets.
+    * @return Card type, CARD_TYPE_UNKNOWN if the tag did not answer.
+    */
+   eCardType_t identifyTarget(uint8_t index);
+
+   /*!
+    * @fn setPassiveActivationRetries
+    * @brief Set how often InListPassiveTarget tries to activate a card before it reports "no card".
+    * @param maxRetries Number of retries, 0xFF retries forever (PN532 default).
+    * @return Boolean type, the result of operation
+    */
+   bool  setPassiveActivationRetries(uint8_t maxRetries);
+
+   /*!
+    * @fn setSerialBaudRate
+    * @brief Change the baud rate of the PN532 HSU (SetSerialBaudRate) and of the serial port.
+    *        Not available over I2C.
+    * @param baud 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 or 1288000.
+    * @return Boolean type, the result of operation
+    */
+   bool  setSerialBaudRate(uint32_t baud) { return transport.setBaudRate(*this,baud); }
+
+
+   Transport transport;    /**<Host link to the PN532*/
+
 private:
-       
-   String readData(int page);
-   virtual void writeCommand(uint8_t *command_data, uint8_t bytes)=0;
-   bool virtual readAck(int x,long timeout = 1000)=0;
+   void  writeCommand(const uint8_t *cmd, uint8_t cmdlen) { transport.writeCommand(*this,cmd,cmdlen); }
+   void  writeFrame_P(const uint8_t *frame, uint8_t len) { transport.writeFrame_P(*this,frame,len); }
+   bool  readAck(int x,long timeout = 0) { return transport.template readAck<ReadyStrategy>(*this,x,timeout); }   /* timeout 0: responseTimeout */
    bool  passWordCheck (int blockNumber,uint8_t nfcuid[],  uint8_t keyData[]);
-   bool  checkDCS(int x);
-   uint8_t getUltraversion(uint8_t block);
-      
+   uint8_t readNTAGRaw(uint8_t block);
+   bool  selectTarget(void);
+   uint8_t listTargets(uint8_t maxTargets, sTarget_t *found);
+   bool  findTarget(const uint8_t *uid, uint8_t uidLength);
 };
-class DFRobot_PN532_IIC : public DFRobot_PN532
+
+class DFRobot_PN532_IIC : public PN532<PN532_I2C, PN532_RuntimeMode>
 {
 public:
 
@@ -201,24 +605,9 @@ public:
    * @param mode Data read mode (interrupt/polling)
    */
    DFRobot_PN532_IIC(uint8_t irq,uint8_t mode);
-   
-  /*!
-   * @fn begin
-   * @brief Initializes the NFC chip
-   * @return Boolean type, the result of operation
-   * @retval true Initialization succeeded
-   * @retval false Initialization failed
-   */
-   bool begin(void);
-    
-        
-private:
-    void writeCommand(uint8_t* cmd, uint8_t cmdlen);
-    bool readAck(int x,long timeout = 1000); 
-    bool waitRemind();
 };
 
-class DFRobot_PN532_UART:public DFRobot_PN532
+class DFRobot_PN532_UART : public PN532<PN532_HSU, PN532_Polling>
 {   
 public:
 #ifdef ESP_PLATFORM
@@ -244,9 +633,5 @@ public:
     */  
     bool begin(HardwareSerial *serial);
 #endif
-private:
-    HardwareSerial *_serial;                
-    void writeCommand(uint8_t *command_data, uint8_t bytes);
-    bool readAck(int x, long timeout = 1000);        
 };
 #endif
\ No newline at end of file
@@ -17,13 +17,14 @@
 #include <stdint.h>
 #include <DFRobot_PN532.h>
 #include <NFC_THMS_to_Serial.h>
+#include <THMS_Profile.h>
+#include <THMS_Retry.h>
+#include <THMS_Serial_Out.h>
+#include <THMS_Format.h>
 
 /*>>>------------------------------------------------------------*/
 /* >> START: Symbols, Enums, Macros & Typedefs*/
-DFRobot_PN532::sCard_t NFCcard;        /* Strukturvariable in welche Angaben zum Tag-Typ abgelegt werden */
-
-#define  PN532_IRQ      (2)           // Interrupt pin. Irrelevant im polling mode
-#define  POLLING        (1)           // Polling mode
+#define  PN532_IRQ      (2)           // Interrupt pin (PN532_Irq, see nt2s_pn532_t)
 
 
 #define MEM_BYTES       (84)  /* Anzahl Bytes, die aus dem Speicher ausgelesen werden; 4 pro Page */
@@ -32,6 +33,17 @@ DFRobot_PN532::sCard_t NFCcard;        /* Strukturvariable in welche Angaben zum
 
 #define NDEF_START_SIGN 0x03  // Start sign for NDEF message in NFC tag raw data
 #define NDEF_END_SIGN   0xFE  // End sign for NDEF message in NFC tag raw data
+#define TLV_NULL        0x00  // NULL TLV (padding, no length)
+#define CC_BLOCK        (3)   // Capability container: E1 <version> <data area size/8> <access>
+#define CC_MAGIC        0xE1
+
+#define NDEF_FLAG_ME            0x40  // Message end
+#define NDEF_FLAG_SR            0x10  // Short record (1 byte payload length)
+#define NDEF_FLAG_IL            0x08  // ID length present
+#define NDEF_TNF_MASK           0x07
+#define NDEF_TNF_WELL_KNOWN     0x01
+#define NDEF_TEXT_UTF16         0x80  // Text record status byte: UTF-16
+#define NDEF_TEXT_LANG_MASK     0x3F  // Text record status byte: length of the language code
 
 #define INITIAL_WRITE_DATA_ARRAY {NDEF_START_SIGN, 0x0D, 0xD1, 0x01,\
                                   0x09, 0x54, 0x02,  'd',\
@@ -39,40 +51,173 @@ DFRobot_PN532::sCard_t NFCcard;        /* Strukturvariable in welche Angaben zum
                                    '0',  '2',  ';', NDEF_END_SIGN,\
                                   0x00, 0x00, 0x00, 0x00,\
                                   0x00, 0x00, 0x00, 0x00 }  /* Initialwerte für NFC-Daten Array */
+#define INSTRUCTION_PAGES     (6)   // Pages of INITIAL_WRITE_DATA_ARRAY (START_BLOCK ... START_BLOCK+5)
+#define IMAGE_CACHE_ENTRIES   (NT2S_MAX_SENSORS)   // Number of sensor-tags (UIDs) whose memory image is cached
+#define NTAG_ATQA_LOW         (0x44) // ATQA 0x0044: ISO14443A type 2 tag with 7 byte UID (NTAG21x)
+
+typedef enum {
+	NDEF_OK,
+	NDEF_READ_ERROR,						// Tag not answering
+	NDEF_FORMAT_ERROR,						// No CC, no NDEF TLV or no text record
+	NDEF_TOO_LONG							// NDEF message does not fit into the message array
+}ndef_result_t;
+
+typedef struct tag_image_t {
+	uint8_t uid[7];
+	uint8_t uid_length;						// 0: Entry unused
+	uint8_t valid_pages;					// Bit i: data of page START_BLOCK+i is known
+	uint8_t data[4*INSTRUCTION_PAGES];		// Last known content of the instruction pages
+}tag_image_t;
 /* >> END: Symbols, Enums, Macros & Typedefs */
 
 
 /*>>>------------------------------------------------------------*/
 /* >> START: Local Variables */
-DFRobot_PN532_IIC  nfc(PN532_IRQ, POLLING);   /* Instanz zum Ansteuern des PN532 via I2C */
+nt2s_pn532_t  nfc(PN532_IRQ);                 /* Instanz zum Ansteuern des PN532 via I2C */
+static nt2s_sensor_t sensors_m[NT2S_MAX_SENSORS];  /* Gefundene Sensor-Tags (Index bleibt je UID erhalten) */
+static uint8_t selected_sensor_m = 0;         /* Sensor-Tag, auf den Lesen/Schreiben wirkt */
+static tag_image_t tag_image_cache_m[IMAGE_CACHE_ENTRIES];  /* Zuletzt bekannter Speicherinhalt je UID */
+static uint8_t tag_image_next_m = 0;          /* Nächster zu ersetzender Eintrag */
+static bool debug_output_m = true;            /* ">>> "-Ausgaben dieser Bibliothek */
+static retry_policy_t read_policy_m = RETRY_POLICY(10, 20, 400, false);    /* Je Lesezugriff (alle Bursts) */
+static retry_policy_t write_policy_m = RETRY_POLICY(5, 20, 400, false);    /* Je Schreibzugriff (alle Seiten) */
+static retry_t access_retry_m;                /* Laufender Tag-Zugriff; bleibt nach vorübergehendem Fehler erhalten */
+static bool access_retry_pending_m = false;   /* true: nächster Aufruf (nach NT2S_retry_after_ms()) setzt den Zugriff fort */
+static uint8_t access_retry_sensor_m = 0;     /* Sensor-Tag des unterbrochenen Zugriffs */
+static DFRobot_PN532::eStatus_t last_status_m = DFRobot_PN532::STATUS_OK;  /* Ursache des letzten Fehlers */
 /* >> END: Local Variables */
 
 /*>>>------------------------------------------------------------*/
 /* >> START: Prototypes (Internal Functions) */
 /************************************************************************************
- * Convert one uint8_t value to a char array of two
- * @return: True if succesful
- * @param[in] byte_value:	uint8 value to be converted
- * @param[in] int_as_char_array_of_2:	pointer to char array for converted hex-chars. Length needs to be 2.
+ * Convert two hex-chars (e.g. "0A") to one uint8_t value
+ * @return: True if succesful (both chars are valid hex-chars)
+ * @param[in] hex_chars:	Pointer to two hex-chars
+ * @param[out] byte_value_p:	Pointer for converted value
  ************************************************************************************/
-static bool byte2hexChar(byte byte_value, char *int_as_char_array_of_2);
+static bool hexChar2byte(const uint8_t hex_chars[], uint8_t * byte_value_p);
 
 /************************************************************************************
- * Reads raw data from thms-sensor.
+ * Reads raw data from thms-sensor. Uses FAST_READ/READ bursts (several pages per RF transaction).
  * @return: True if succesful.
  * @param[in] read_tag_data:	Pointer to array for raw data. (!Length must be > data_array_length).
+ * @param[in] first_block:	First page to be read.
  * @param[in] data_array_length:	Length of data to be read. 
  ************************************************************************************/
-bool read_data(uint8_t read_tag_data[], size_t data_array_length);
+static bool read_data(uint8_t read_tag_data[], uint8_t first_block, size_t data_array_length);
 
 /************************************************************************************
- * Search ndef text data entry in raw data
- * @return: True if succesful.
- * @param[in] raw_data_array:	Pointer to array for raw data. 
- * @param[out] text_start_index: Pointer to variable for start-point of text in raw data. 
- * @param[out] text_length:	Pointer to variable for length of text.
+ * Make sure the first "needed" bytes of the data area (from START_BLOCK on) are loaded.
+ * Only the missing pages are read.
+ * @return: NDEF_OK, NDEF_READ_ERROR or NDEF_TOO_LONG (does not fit into raw_data_array).
+ * @param[in,out] raw_data_array:	Data area from START_BLOCK on.
+ * @param[in] max_length:	Length of raw_data_array.
+ * @param[in,out] loaded_p:	Number of bytes already loaded (multiple of 4).
+ * @param[in] needed:	Number of bytes needed.
+ ************************************************************************************/
+static ndef_result_t fetch_data_area(uint8_t raw_data_array[], uint8_t max_length, uint16_t * loaded_p, uint16_t needed);
+
+/************************************************************************************
+ * Walk the TLVs of the data area up to the NDEF message TLV (0x03). Loads pages as needed.
+ * @return: NDEF_OK if found.
+ * @param[in] data_area_size:	Size of the data area from the capability container.
+ * @param[out] ndef_start_p:	Offset of the NDEF message in raw_data_array.
+ * @param[out] ndef_length_p:	Length of the NDEF message.
+ ************************************************************************************/
+static ndef_result_t search_ndef_tlv(uint8_t raw_data_array[], uint8_t max_length, uint16_t * loaded_p,
+                                     uint16_t data_area_size, uint16_t * ndef_start_p, uint16_t * ndef_length_p);
+
+/************************************************************************************
+ * Search the first text record (well known type "T", UTF-8, any language code) in a NDEF message.
+ * @return: True if found.
+ * @param[in] raw_data_array:	Raw data containing the NDEF message.
+ * @param[in] ndef_start:	Offset of the NDEF message.
+ * @param[in] ndef_length:	Length of the NDEF message.
+ * @param[out] text_start_index_p:	Offset of the text (without status byte and language code).
+ * @param[out] text_length_p:	Length of the text.
+ ************************************************************************************/
+static bool search_text_record(const uint8_t raw_data_array[], uint16_t ndef_start, uint16_t ndef_length,
+                               uint16_t * text_start_index_p, uint16_t * text_length_p);
+
+/************************************************************************************
+ * Search "Do:xx" in raw data
+ * @return: True if found and valid hex-chars.
+ * @param[in] raw_data_array:	Pointer to array for raw data.
+ * @param[in] length:	Length of raw_data_array.
+ * @param[out] do_instruction_p:	Pointer for found Do-instruction.
+ ************************************************************************************/
+static bool search_do_instruction(const uint8_t raw_data_array[], uint8_t length, uint8_t * do_instruction_p);
+
+/************************************************************************************
+ * Get the cached memory image of the last selected sensor-tag (new entry if unknown).
+ * @return: Pointer to cache entry; NULL if no tag has been selected yet.
+ ************************************************************************************/
+static tag_image_t * image_cache_entry(void);
+
+/************************************************************************************
+ * Update the cached memory image with raw data read from START_BLOCK on. The data is
+ * only cached if the tag is not busy (Do-instruction it will not answer: 00, 01, FF),
+ * otherwise the tag will overwrite it and the image is invalidated.
+ * @param[in] raw_data_array:	Raw data beginning with page START_BLOCK.
+ * @param[in] length:	Length of raw_data_array.
+ ************************************************************************************/
+static void image_cache_update(const uint8_t raw_data_array[], uint8_t length);
+
+/************************************************************************************
+ * Plan which instruction pages have to be written.
+ * @return: Bit i set: page START_BLOCK+i has to be written.
+ * @param[in] data:	Intended content of the instruction pages.
+ * @param[in] known_data:	Last known content of the instruction pages.
+ * @param[in] known_pages:	Bit i set: page i of known_data is valid.
+ ************************************************************************************/
+static uint8_t plan_instruction_write(const uint8_t data[], const uint8_t known_data[], uint8_t known_pages);
+
+/************************************************************************************
+ * Begin a PN532 session bound to the UID of the selected sensor-tag (before the first
+ * search: the first tag in the field).
+ * @return: True if the tag is selected.
+ ************************************************************************************/
+static bool begin_sensor_session(void);
+
+/************************************************************************************
+ * Count consecutive failed accesses of the selected sensor-tag. After NT2S_MAX_FAILURES
+ * the sensor-tag is marked as not present (removed) until the next search.
+ * @param[in] success:	Result of the access.
+ ************************************************************************************/
+static void sensor_access_result(bool success);
+
+/************************************************************************************
+ * Start a tag access with the policy, or continue the access that was interrupted
+ * by a transient error (same policy and sensor-tag, see NT2S_retry_after_ms()).
+ ************************************************************************************/
+static void begin_access(retry_policy_t * policy);
+
+/************************************************************************************
+ * One step of the access failed (nfc.lastStatus()). No waiting here: the caller
+ * returns and is called again after NT2S_retry_after_ms().
+ * @return: True if the access may be continued by a later call.
  ************************************************************************************/
-bool search_text_ndef(uint8_t raw_data_array[], uint8_t max_length, uint8_t * text_start_index_p, uint8_t * text_length_p);
+static bool access_step_failed(void);
+
+/************************************************************************************
+ * End the PN532 session of the access. A failure only counts for the sensor-tag
+ * (sensor_access_result()) when the access is given up.
+ * @param[in] success:	Result of the access.
+ ************************************************************************************/
+static void end_access(bool success);
+
+/************************************************************************************
+ * UID of the selected sensor-tag; before the first search the UID of the last selected tag.
+ * @return: Length of the UID (0: unknown).
+ * @param[out] uid_p:	Pointer to the UID.
+ ************************************************************************************/
+static uint8_t selected_uid(const uint8_t ** uid_p);
+
+/************************************************************************************
+ * Get the sensor entry for a UID: known entry or free (not present) entry.
+ * @return: Pointer to entry; NULL if all entries are in use.
+ ************************************************************************************/
+static nt2s_sensor_t * sensor_entry(const uint8_t uid[], uint8_t uid_length);
 
 /* >> END: Prototypes */
 
@@ -84,87 +229,196 @@ bool init_NT2S() {
 }
 
 bool NT2S_search_sensor(void) {
-  if (nfc.scan()) {     /* Prüfen Anwesenheit NFC-Tag */
-    NFCcard = nfc.getInformation();     // Tag-Infoprmations (UID, AQTA, Type, ...) 
-    delay(50); // Hilft möglicherweise bei Fehlermeldung ">>> Wrong tag-type: Ultralight"
-    if (memcmp(NFCcard.cardType, "Ultralight", 10) != 0) {  // ENTFERNEN ?!?!
-      if(NFCcard.AQTA[1] == 0x44) {
-        return true;
-      } else {        
-        //Serial.print(">>> Error ATQA: 0x"); Serial.println(NFCcard.AQTA[1]); 
-        // AQTA vermutlich Schreibfehler und sollte ATQA sein!!!!  => Answert to Request Type A
-      }
-    } else {
-      // Serial.print(">>> Wrong tag-type: "); Serial.println(NFCcard.cardType);
-      // ToDo: Gelegentlich wird (memcmp(NFCcard.cardType, "Ultralight", 10) == 0) erkannt und zugleich ist NFCcard.cardType==Ultralight
+  return (NT2S_search_sensors() > 0);
+}
+
+/*
+Alle Tags im Feld mit einem InListPassiveTarget auflisten (max. NT2S_MAX_SENSORS bzw. was der Transport empfangen kann).
+Sensor-Tags: ATQA 0x0044 und laut GET_VERSION ein NTAG21x. Der Typ wird je UID nur einmal bestimmt.
+*/
+uint8_t NT2S_search_sensors(void) {
+  uint8_t found = nfc.scanTargets(NT2S_MAX_SENSORS);   /* Prüfen Anwesenheit NFC-Tags */
+  last_status_m = nfc.lastStatus();
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < NT2S_MAX_SENSORS; i++) sensors_m[i].present = false;
+  for (uint8_t t = 0; t < found; t++) {
+    const DFRobot_PN532::sTarget_t * target = &nfc.targets[t];
+    if ((target->ATQA[0] != 0x00) || (target->ATQA[1] != NTAG_ATQA_LOW)) continue;   // Kein Sensor-Tag
+    nt2s_sensor_t * sensor = sensor_entry(target->uid, target->uidLength);
+    if (sensor == NULL) continue;
+    if ((sensor->uid_length != target->uidLength) || (memcmp(sensor->uid, target->uid, target->uidLength) != 0)) {
+      DFRobot_PN532::eCardType_t type = nfc.identifyTarget(t);   // Neuer Sensor-Tag
+      if (!DFRobot_PN532::isNTAG(type)) continue;   // Kein NTAG21x (z.B. Ultralight) oder keine Antwort -> nächste Suche
+      memcpy(sensor->uid, target->uid, target->uidLength);
+      sensor->uid_length = target->uidLength;
+      sensor->type = type;
+      sensor->fast_read_unsupported = false;
     }
+    sensor->present = true;
+    sensor->failures = 0;
+    count++;
   }
-  return false;
+  if ((count == 0) && (found > 0)) last_status_m = DFRobot_PN532::STATUS_NO_TARGET;   // Nur andere Tags im Feld
+  if ((count > 0) && !sensors_m[selected_sensor_m].present) {
+    for (uint8_t i = 0; i < NT2S_MAX_SENSORS; i++) {
+      if (sensors_m[i].present) { selected_sensor_m = i; break; }
+    }
+  }
+  return count;
+}
+
+DFRobot_PN532::eStatus_t NT2S_last_status(void) {
+  return last_status_m;
 }
 
+bool NT2S_select_sensor(uint8_t index) {
+  if ((index >= NT2S_MAX_SENSORS) || !sensors_m[index].present) return false;
+  selected_sensor_m = index;
+  return true;
+}
+
+uint8_t NT2S_selected_sensor(void) {
+  return selected_sensor_m;
+}
+
+const nt2s_sensor_t * NT2S_get_sensor(uint8_t index) {
+  if (index >= NT2S_MAX_SENSORS) return NULL;
+  return &sensors_m[index];
+}
+
+/*
+NDEF-Text lesen: zuerst CC und Anfang des Datenbereichs (Seiten 3-6, eine READ-Antwort), dann nur die Seiten,
+die die NDEF-Nachricht laut TLV-Länge noch umfasst. Die Rohdaten liegen ab Seite START_BLOCK in message_array,
+der Text wird dort an den Anfang geschoben und mit '\0' abgeschlossen.
+*/
 bool NT2S_read_ndef_text(uint8_t message_array[], uint8_t max_length) {
-  //Serial.print(F("Size of message_array: ")); Serial.println((int)(sizeof(message_array)/sizeof(message_array[0])),DEC); // Antwort = 255 -> ?!? O.o Kann nicht sein   
-  uint8_t text_start_index = 0;
-  uint8_t text_length = 0;
-  bool read_success_indicator = read_data(message_array,max_length);
-
-  if (read_success_indicator) {
-    search_text_ndef(message_array,max_length,&text_start_index,&text_length);
-    if (((text_length+text_start_index) < max_length) && (text_length>3)) {
-      text_start_index = text_start_index+2; // Exclude language code -> +2 -2
-      text_length = text_length-2;      // Exclude language code -> +2 -2
-      memmove(message_array,&message_array[text_start_index],text_length);
-      memset(&message_array[text_length],'\0',(max_length-(text_length)));
+  uint8_t head[4*NTAG_PAGES_PER_READ];
+  uint16_t loaded = 0;
+  uint16_t ndef_start = 0;
+  uint16_t ndef_length = 0;
+  ndef_result_t result = NDEF_READ_ERROR;
+  begin_access(&read_policy_m);
+  begin_sensor_session();   // Tag einmal selektieren, nicht vor jeder Seite
+  if (read_data(head, CC_BLOCK, sizeof(head))) {
+    loaded = (max_length < sizeof(head) - 4) ? (max_length & ~3) : (sizeof(head) - 4);
+    memcpy(message_array, &head[4], loaded);
+    result = NDEF_FORMAT_ERROR;
+    if (head[0] == CC_MAGIC) {
+      result = search_ndef_tlv(message_array, max_length, &loaded, 8*head[2], &ndef_start, &ndef_length);
+    }
+    if (result == NDEF_OK) {
+      if (ndef_start + ndef_length >= max_length) result = NDEF_TOO_LONG;   // Platz für '\0'
+      else result = fetch_data_area(message_array, max_length, &loaded, ndef_start + ndef_length);
+    }
+  }
+  end_access(result != NDEF_READ_ERROR);
+
+  if (result == NDEF_OK) {
+    image_cache_update(message_array, loaded);
+    uint16_t text_start_index;
+    uint16_t text_length;
+    if (search_text_record(message_array, ndef_start, ndef_length, &text_start_index, &text_length)) {
+      memmove(message_array, &message_array[text_start_index], text_length);
+      message_array[text_length] = '\0';
       return true;
-    } else {
-      Serial.println(F(">>> NDEF message size error!!!"));
-      Serial.print(F(">>> >Start: "));Serial.println(text_start_index);
-      Serial.print(F(">>> >Length: "));Serial.println(text_length);
     }
+    result = NDEF_FORMAT_ERROR;
+  }
+  if (debug_output_m && (result == NDEF_TOO_LONG)) {
+    sout.print(F(">>> NDEF message too long: ")); sout.println(ndef_length);
+  } else if (debug_output_m && (result == NDEF_FORMAT_ERROR)) {
+    sout.println(F(">>> No NDEF text message!!!"));
   }
   return false;
 }
 
 // Checken ob "sizeof(memory_data_array)" so OK
 bool NT2S_read_raw(uint8_t memory_data_array[], uint8_t length) {
-  return read_data(memory_data_array,length);
+  begin_access(&read_policy_m);
+  begin_sensor_session();
+  bool read_success_indicator = read_data(memory_data_array,START_BLOCK,length);
+  end_access(read_success_indicator);
+  if (read_success_indicator) image_cache_update(memory_data_array,length);
+  return read_success_indicator;
 }
 
 /*
-NDEF-Textnachricht mit Do-Instruction in Memory des Sensor-Tags schreiben
+NDEF-Textnachricht mit Do-Instruction in Memory des Sensor-Tags schreiben.
+Geschrieben werden nur Seiten, die sich vom zuletzt bekannten Speicherinhalt (Cache je UID) unterscheiden.
+Ist dieser unbekannt, wird er einmal zurückgelesen (günstiger als 6 Seiten zu schreiben).
 */
 bool NT2S_set_instruction(uint8_t do_instruction){
+  PROF_SCOPE(PROF_SET_INSTRUCTION);
   char instruction[2];
-  uint8_t data[24] = INITIAL_WRITE_DATA_ARRAY;
-  if(!byte2hexChar(do_instruction, instruction)) return false;
+  uint8_t data[4*INSTRUCTION_PAGES] = INITIAL_WRITE_DATA_ARRAY;
+  fmt_hex(instruction, do_instruction, 2);
   data[12] = instruction[0];
   data[13] = instruction[1];
-  for (unsigned int i = 0 ; i < 6; i++ ) {  // Write 6 Seiten (=24 Bytes)
-    unsigned int try_counter = 5;
-    bool write_success = false;
-    do {
-      write_success = nfc.writeNTAG(i+START_BLOCK, &data[i*4]);
-      if(!write_success) delay(200);
-      try_counter--;
-    } while((try_counter != 0) && (write_success != true));
-    if (!write_success) return false;
+  begin_access(&write_policy_m);
+  begin_sensor_session();   // Tag einmal selektieren; nach RF-/Timeout-Fehler erneut im nächsten Aufruf
+  uint8_t known_data[4*INSTRUCTION_PAGES];
+  uint8_t known_pages = 0;
+  tag_image_t * image = image_cache_entry();
+  if (image != NULL) {
+    memcpy(known_data, image->data, sizeof(known_data));
+    known_pages = image->valid_pages;
   }
+  uint8_t pages_to_write = plan_instruction_write(data, known_data, known_pages);
+  if ((pages_to_write & ~known_pages) != 0) {   // Unbekannte Seiten -> zurücklesen
+    if (read_data(known_data, START_BLOCK, sizeof(known_data))) {
+      image_cache_update(known_data, sizeof(known_data));
+      pages_to_write = plan_instruction_write(data, known_data, (1 << INSTRUCTION_PAGES) - 1);
+    }
+  }
+  for (unsigned int i = 0 ; i < INSTRUCTION_PAGES; i++ ) {  // Write max. 6 Seiten (=24 Bytes)
+    if (!(pages_to_write & (1 << i))) continue;   // Seite unverändert
+    nfc.setResponseTimeout(retry_response_timeout_ms(&access_retry_m));
+    if (nfc.writeNTAG(i+START_BLOCK, &data[i*4])) {
+      retry_succeeded(&access_retry_m);
+      continue;
+    }
+    if (access_step_failed()) PROF_RETRY(PROF_SET_INSTRUCTION);
+    image = image_cache_entry();
+    if (image != NULL) image->valid_pages = 0;   // Seiteninhalt ungewiss -> beim Fortsetzen zurücklesen
+    end_access(false);
+    return false;
+  }
+  image_cache_update(data, sizeof(data));   // Bei aktiver Instruction: Tag überschreibt -> ungültig
+  end_access(true);
   return true;
 }
 
+/*
+Nur die erste READ-Antwort (Seiten 4-7) lesen: NDEF-Header und "Do:xx" liegen immer darin.
+Kein Wiederholen bei Fehlern; wird zyklisch aufgerufen. Fehler zählen nicht als Ausfall (Tag misst evtl. gerade).
+*/
+bool NT2S_read_do_instruction(uint8_t * do_instruction_p) {
+  uint8_t raw_data[4*NTAG_PAGES_PER_READ];
+  begin_sensor_session();
+  bool read_success_indicator = (nfc.readNTAGPages(raw_data, START_BLOCK) == 1);
+  nfc.endSession();
+  if (!read_success_indicator) return false;
+  image_cache_update(raw_data, sizeof(raw_data));
+  return search_do_instruction(raw_data, sizeof(raw_data), do_instruction_p);
+}
+
+uint16_t NT2S_retry_after_ms(void) {
+  return access_retry_pending_m ? access_retry_m.backoff_ms : 0;
+}
+
+uint8_t NT2S_get_uid(uint8_t uid[]) {
+  const uint8_t * selected;
+  uint8_t length = selected_uid(&selected);
+  memcpy(uid, selected, length);
+  return length;
+}
+
+void NT2S_set_debug_output(bool enable) {
+  debug_output_m = enable;
+}
+
 bool NT2S_set_do2_instruction(void){
-  uint8_t data[24] = INITIAL_WRITE_DATA_ARRAY; 
-  for (unsigned int i = 0 ; i < 6; i++ ) {
-    unsigned int try_counter = 5;
-    bool write_success = false;
-    do {
-      write_success = nfc.writeNTAG(i+START_BLOCK, &data[i*4]);
-      if(!write_success) delay(200);
-      try_counter--;
-    } while((try_counter != 0) && (write_success != true));
-    if (!write_success) return false;
-  }
-  return true;
+  return NT2S_set_instruction(NT2S_DO_SINGLE_MEASUREMENT);
 }
 
 
@@ -200,80 +454,242 @@ bool check_do_instruction(uint8_t do_instruction) {
 
 /*>>>------------------------------------------------------------*/
 /* >> START: Internal (Static) Functions */
-static bool byte2hexChar(byte byte_value, char * int_as_char_array_of_2) {
-	char hex_char_array[3] = "00"; // Null termination
-  memset(int_as_char_array_of_2,'0',2); // Set char array to "00"
-	int n = sprintf(hex_char_array,"%2X",byte_value); //print integer value to char array as hex-vale
-  //Serial.print(">>> Got HEX instruction: 0x");Serial.println(byte_value,HEX);
-	if((n == 1) || (n == 2)) { //Check if number of written chars is ok
-    memcpy(int_as_char_array_of_2,hex_char_array,2);
-    //Serial.print(">>> HEX-Ascii instruction: ");Serial.print(int_as_char_array_of_2[0]);Serial.println(int_as_char_array_of_2[1]);
-		return true; 
-	}
-	return false;
-}
-
-/* Auslesen memory und Ablegen in Array. Auslesen nur Blockweise (4Bytes) möglich. Wenn z.B. data_array_length = 10, dann werden nur 2 Blöcke gelesen!*/ 
-bool read_data(uint8_t read_tag_data[], size_t data_array_length){       
-  //Serial.print(F("Size of read_tag_data: ")); Serial.println((int)(sizeof(read_tag_data)/sizeof(read_tag_data[0])),DEC);
-  //Serial.print(F("Pointer to read_tag_data: ")); Serial.println((uint8_t) &read_tag_data[0],HEX);
-  //int read_byte_lengt = 0;
+static bool hexChar2byte(const uint8_t hex_chars[], uint8_t * byte_value_p) {
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    uint8_t digit = fmt_digit_value((char)hex_chars[i], 16);
+    if (digit == 0xFF) return false;
+    value = (value << 4) | digit;
+  }
+  *byte_value_p = value;
+  return true;
+}
+
+static bool search_do_instruction(const uint8_t raw_data_array[], uint8_t length, uint8_t * do_instruction_p) {
+  for (uint8_t i = 0; (i + 4) < length; i++) {
+    if ((raw_data_array[i] == 'D') && (raw_data_array[i+1] == 'o') && (raw_data_array[i+2] == ':')) {
+      return hexChar2byte(&raw_data_array[i+3], do_instruction_p);
+    }
+  }
+  return false;
+}
+
+static tag_image_t * image_cache_entry(void) {
+  const uint8_t * uid;
+  uint8_t uid_length = selected_uid(&uid);
+  if (uid_length == 0) return NULL;
+  for (uint8_t i = 0; i < IMAGE_CACHE_ENTRIES; i++) {
+    tag_image_t * image = &tag_image_cache_m[i];
+    if ((image->uid_length == uid_length) && (memcmp(image->uid, uid, uid_length) == 0)) {
+      return image;
+    }
+  }
+  tag_image_t * image = &tag_image_cache_m[tag_image_next_m];   // Unbekannter Tag: ältesten Eintrag ersetzen
+  tag_image_next_m = (tag_image_next_m + 1) % IMAGE_CACHE_ENTRIES;
+  memcpy(image->uid, uid, uid_length);
+  image->uid_length = uid_length;
+  image->valid_pages = 0;
+  return image;
+}
+
+static void image_cache_update(const uint8_t raw_data_array[], uint8_t length) {
+  tag_image_t * image = image_cache_entry();
+  if (image == NULL) return;
+  uint8_t do_instruction;
+  image->valid_pages = 0;   // Nicht gelesene Seiten kann der Tag inzwischen geändert haben
+  if (!search_do_instruction(raw_data_array, length, &do_instruction)) return;
+  if ((do_instruction != NT2S_INIT) && (do_instruction != NT2S_IDLE) && (do_instruction != NT2S_ERROR)) return;
+  uint8_t pages = (length/4 < INSTRUCTION_PAGES) ? length/4 : INSTRUCTION_PAGES;
+  memcpy(image->data, raw_data_array, 4*pages);
+  image->valid_pages = (1 << pages) - 1;
+}
+
+static bool begin_sensor_session(void) {
+  const nt2s_sensor_t * sensor = &sensors_m[selected_sensor_m];
+  if (sensor->uid_length == 0) return nfc.beginSession();   // Noch nicht gesucht: erster Tag im Feld
+  return nfc.beginSession(sensor->uid, sensor->uid_length);
+}
+
+static void sensor_access_result(bool success) {
+  nt2s_sensor_t * sensor = &sensors_m[selected_sensor_m];
+  if (success) {
+    sensor->failures = 0;
+  } else if (sensor->failures < NT2S_MAX_FAILURES) {
+    sensor->failures++;
+    if (sensor->failures >= NT2S_MAX_FAILURES) sensor->present = false;   // Tag vermutlich entfernt
+  }
+}
+
+static void begin_access(retry_policy_t * policy) {
+  if (access_retry_pending_m && (access_retry_m.policy == policy) && (access_retry_sensor_m == selected_sensor_m)) {
+    retry_resume(&access_retry_m);   // Backoff wurde außerhalb abgewartet
+  } else {
+    retry_begin(&access_retry_m, policy);
+    access_retry_sensor_m = selected_sensor_m;
+  }
+  access_retry_pending_m = false;
+}
+
+static bool access_step_failed(void) {
+  last_status_m = nfc.lastStatus();
+  access_retry_pending_m = retry_failed(&access_retry_m, last_status_m);
+  return access_retry_pending_m;
+}
+
+static void end_access(bool success) {
+  nfc.setResponseTimeout(PN532_RESPONSE_TIMEOUT_MS);
+  nfc.endSession();
+  if (success) access_retry_pending_m = false;   // Z.B. Zurücklesen fehlgeschlagen, Schreiben erfolgreich
+  if (success || !access_retry_pending_m) sensor_access_result(success);
+}
+
+static uint8_t selected_uid(const uint8_t ** uid_p) {
+  const nt2s_sensor_t * sensor = &sensors_m[selected_sensor_m];
+  if (sensor->uid_length != 0) {
+    *uid_p = sensor->uid;
+    return sensor->uid_length;
+  }
+  *uid_p = nfc.targetUid;
+  return nfc.targetUidLength;
+}
+
+static nt2s_sensor_t * sensor_entry(const uint8_t uid[], uint8_t uid_length) {
+  nt2s_sensor_t * free_entry = NULL;
+  for (uint8_t i = 0; i < NT2S_MAX_SENSORS; i++) {
+    nt2s_sensor_t * sensor = &sensors_m[i];
+    if ((sensor->uid_length == uid_length) && (memcmp(sensor->uid, uid, uid_length) == 0)) return sensor;
+    if ((free_entry == NULL) && !sensor->present) free_entry = sensor;
+  }
+  return free_entry;
+}
+
+/* Bytes hinter dem NDEF-Endezeichen werden vom Tag nicht ausgewertet und müssen nicht übereinstimmen */
+static uint8_t plan_instruction_write(const uint8_t data[], const uint8_t known_data[], uint8_t known_pages) {
+  uint8_t pages_to_write = 0;
+  uint8_t relevant_length = 4*INSTRUCTION_PAGES;
+  for (uint8_t i = 0; i < 4*INSTRUCTION_PAGES; i++) {
+    if (data[i] == NDEF_END_SIGN) { relevant_length = i + 1; break; }
+  }
+  for (uint8_t i = 0; i < relevant_length; i++) {
+    uint8_t page = i/4;
+    if (!(known_pages & (1 << page)) || (data[i] != known_data[i])) pages_to_write |= (1 << page);
+  }
+  return pages_to_write;
+}
+
+/* Auslesen memory und Ablegen in Array. Auslesen nur Blockweise (4Bytes) möglich. Wenn z.B. data_array_length = 10, dann werden nur 2 Blöcke gelesen!
+   Gelesen wird in Bursts: FAST_READ liest NTAG_FAST_READ_MAX_PAGES Seiten pro Befehl (NTAG21x laut GET_VERSION),
+   READ 4 Seiten pro Befehl (andere Typen oder nachdem der Tag FAST_READ abgelehnt hat). */ 
+static bool read_data(uint8_t read_tag_data[], uint8_t first_block, size_t data_array_length){       
+  PROF_SCOPE(PROF_READ_DATA);
   unsigned int number_of_blocks_to_read = (data_array_length/4);
-  for (unsigned int block_no = 0; block_no < number_of_blocks_to_read; block_no++) {
-    uint8_t data_array_write_pointer = 4*block_no;
-    //Serial.print(F("Array write pointer: ")); Serial.println(data_array_write_pointer,DEC); // Antwort = 255 -> ?!? O.o Kann nicht sein
-    uint8_t DFRobot_success_indicator = 0;
-    int try_counter = 10;
-    while ((DFRobot_success_indicator != 1) && (try_counter > 0)) {
-      uint8_t read_data_array[5]; // Eins mehr zur Sicherheit 
-      DFRobot_success_indicator = nfc.readNTAG(read_data_array, (block_no+START_BLOCK));
-
-      //Serial.print(F("Success indicator: ")); Serial.println(DFRobot_success_indicator,DEC); 
-      //Serial.print(F("Try counter: ")); Serial.println(try_counter,DEC); 
-      if(data_array_write_pointer>data_array_length) Serial.println(F(">>> FATAL ARRAY WRITE ERROR "));
-      memcpy(&read_tag_data[data_array_write_pointer], read_data_array, 4);
-      try_counter--;
-      if(DFRobot_success_indicator != 1) delay(200);
-      Serial.flush();
+  unsigned int block_no = 0;
+  while (block_no < number_of_blocks_to_read) {
+    unsigned int blocks_left = number_of_blocks_to_read - block_no;
+    unsigned int blocks_read = 0;
+    nfc.setResponseTimeout(retry_response_timeout_ms(&access_retry_m));
+    nt2s_sensor_t * sensor = &sensors_m[selected_sensor_m];
+    bool fast_read = DFRobot_PN532::isNTAG((DFRobot_PN532::eCardType_t)sensor->type) && !sensor->fast_read_unsupported;
+    if (fast_read) {
+      uint8_t blocks_in_burst = (blocks_left < NTAG_FAST_READ_MAX_PAGES) ? blocks_left : NTAG_FAST_READ_MAX_PAGES;
+      if (nfc.fastReadNTAG(&read_tag_data[4*block_no], block_no+first_block, block_no+first_block+blocks_in_burst-1) == 1) {
+        blocks_read = blocks_in_burst;
+      } else if (nfc.lastStatus() == DFRobot_PN532::STATUS_COMMAND_ERROR) {
+        sensor->fast_read_unsupported = true;   // Tag hat FAST_READ abgelehnt (NAK) -> READ, auch gleich in diesem Versuch
+        fast_read = false;
+      }
+    }
+    if ((blocks_read == 0) && !fast_read) {   // Andere FAST_READ-Fehler (RF, Timeout) wiederholt der nächste Aufruf
+      uint8_t read_data_array[4*NTAG_PAGES_PER_READ];
+      if (nfc.readNTAGPages(read_data_array, (block_no+first_block)) == 1) {
+        blocks_read = (blocks_left < NTAG_PAGES_PER_READ) ? blocks_left : NTAG_PAGES_PER_READ;
+        memcpy(&read_tag_data[4*block_no], read_data_array, 4*blocks_read);
+      }
     }
-    if(try_counter <= 0) {
+    if(blocks_read == 0) {
+      if (access_step_failed()) {
+        PROF_RETRY(PROF_READ_DATA);
+      } else if (debug_output_m) {   // Tag entfernt oder keine Versuche mehr
+        sout.print(F(">>> Read was not successful: "));
+        sout.println(DFRobot_PN532::statusName(last_status_m));
+      }
       return false;
-      Serial.println(F(">>> Read was not successful!")); Serial.flush(); 
     }
-    //read_byte_lengt = block_no*4;
+    retry_succeeded(&access_retry_m);
+    block_no += blocks_read;
   }
-  //if(read_length_p) *read_length_p = read_byte_lengt;
-  //Serial.println(F("Read successful!")); Serial.flush(); 
   return true;   
 }
 
-/* Suchen von NDEF Text Message in gelesenen Rohdaten */
-bool search_text_ndef(uint8_t raw_data_array[], uint8_t max_length, uint8_t * text_start_index_p,uint8_t * text_length_p){
-  enum{NDEF_Start, Text_Start, NDEF_End};
-  int search_state = NDEF_Start;
-  if(max_length<5) return false;
-
-  for (int i = 0; i < max_length; i++){
-    switch(search_state) {
-      case NDEF_Start:
-        if(raw_data_array[i] == NDEF_START_SIGN) {
-          search_state = Text_Start;
-        }
-        break;
-      case Text_Start:
-        if((raw_data_array[i] == 0x64) && (raw_data_array[i+1] == 0x65)) {  // ="de"
-          search_state = NDEF_End;
-          *text_start_index_p = i;
-          i++;
-        }
-        break;
-      case NDEF_End:
-        if(raw_data_array[i] == NDEF_END_SIGN) {
-          *text_length_p = i - (*text_start_index_p);
-          return true;
-        }
-        break;
+static ndef_result_t fetch_data_area(uint8_t raw_data_array[], uint8_t max_length, uint16_t * loaded_p, uint16_t needed) {
+  if (needed <= *loaded_p) return NDEF_OK;
+  uint16_t end = (needed + 3) & ~3;   // Nur ganze Seiten
+  if (end > max_length) return NDEF_TOO_LONG;
+  if (!read_data(&raw_data_array[*loaded_p], START_BLOCK + (*loaded_p)/4, end - *loaded_p)) return NDEF_READ_ERROR;
+  *loaded_p = end;
+  return NDEF_OK;
+}
+
+/* TLV: Tag (1 Byte), Länge (1 Byte oder 0xFF + 2 Byte), Wert. NULL-TLV ohne Länge, Terminator-TLV (0xFE) beendet. */
+static ndef_result_t search_ndef_tlv(uint8_t raw_data_array[], uint8_t max_length, uint16_t * loaded_p,
+                                     uint16_t data_area_size, uint16_t * ndef_start_p, uint16_t * ndef_length_p) {
+  uint16_t i = 0;
+  while (i < data_area_size) {
+    ndef_result_t result = fetch_data_area(raw_data_array, max_length, loaded_p, i + 2);
+    if (result != NDEF_OK) return result;
+    uint8_t tag = raw_data_array[i];
+    if (tag == TLV_NULL) { i++; continue; }
+    if (tag == NDEF_END_SIGN) return NDEF_FORMAT_ERROR;
+    uint16_t length = raw_data_array[i+1];
+    uint8_t header_length = 2;
+    if (length == 0xFF) {   // 3-Byte-Längenfeld
+      result = fetch_data_area(raw_data_array, max_length, loaded_p, i + 4);
+      if (result != NDEF_OK) return result;
+      length = ((uint16_t)raw_data_array[i+2] << 8) | raw_data_array[i+3];
+      header_length = 4;
+    }
+    if (tag == NDEF_START_SIGN) {
+      *ndef_start_p = i + header_length;
+      *ndef_length_p = length;
+      return NDEF_OK;
+    }
+    i += header_length + length;   // Lock-/Memory-Control-TLV o.ä. überspringen
+  }
+  return NDEF_FORMAT_ERROR;
+}
+
+/* Record: Header (MB ME CF SR IL TNF), Type length, Payload length (1 oder 4 Byte), [ID length], Type, [ID], Payload */
+static bool search_text_record(const uint8_t raw_data_array[], uint16_t ndef_start, uint16_t ndef_length,
+                               uint16_t * text_start_index_p, uint16_t * text_length_p) {
+  uint16_t i = ndef_start;
+  uint16_t end = ndef_start + ndef_length;
+  while (i + 3 <= end) {
+    uint8_t header = raw_data_array[i++];
+    uint8_t type_length = raw_data_array[i++];
+    uint32_t payload_length = raw_data_array[i++];
+    if (!(header & NDEF_FLAG_SR)) {
+      if (i + 3 > end) return false;
+      for (uint8_t k = 0; k < 3; k++) payload_length = (payload_length << 8) | raw_data_array[i++];
+    }
+    uint8_t id_length = 0;
+    if (header & NDEF_FLAG_IL) {
+      if (i >= end) return false;
+      id_length = raw_data_array[i++];
+    }
+    uint16_t type_index = i;
+    i += type_length + id_length;
+    if ((i > end) || (payload_length > (uint32_t)(end - i))) return false;   // Record länger als Nachricht
+    uint16_t payload_index = i;
+    i += payload_length;
+    if (((header & NDEF_TNF_MASK) == NDEF_TNF_WELL_KNOWN) && (type_length == 1) && (raw_data_array[type_index] == 'T')
+        && (payload_length >= 1) && !(raw_data_array[payload_index] & NDEF_TEXT_UTF16)) {
+      uint8_t lang_length = raw_data_array[payload_index] & NDEF_TEXT_LANG_MASK;
+      if ((uint32_t)lang_length + 1 > payload_length) return false;
+      *text_start_index_p = payload_index + 1 + lang_length;
+      *text_length_p = payload_length - 1 - lang_length;
+      return true;
     }
+    if (header & NDEF_FLAG_ME) break;
   }
   return false;
 }
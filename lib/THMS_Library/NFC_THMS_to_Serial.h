@@ -22,8 +22,6 @@
 
 /*>>>------------------------------------------------------------*/
 /* >> START: Symbols, Enums, Macros & Typedefs*/
-#define MAX_BYTE_SIZE_TO_READ_FROM_TAG  60 //84
-
 typedef enum {
 	NT2S_INIT						   	= 0x00U,
 	NT2S_IDLE 						   	= 0x01U,
@@ -34,10 +32,20 @@ typedef enum {
 	NT2S_ERROR							= 0xFFU  // Unknown instruction.
 }nt2s_do_instructions_t;		// If changed update also "instruction_ascii_2_enum()" function!
 
-typedef struct data_array_t {
-	uint8_t length;
-	char x[MAX_BYTE_SIZE_TO_READ_FROM_TAG];
-}data_array_t;
+#define NT2S_MAX_SENSORS   PN532_MAX_TARGETS  // Sensor-tags handled at the same time (PN532: max. 2 per InListPassiveTarget)
+#define NT2S_MAX_FAILURES  3                  // Consecutive failed accesses until a sensor-tag counts as removed
+
+typedef PN532<PN532_I2C, PN532_Irq> nt2s_pn532_t;  // PN532 via I2C, frame ready signalled by the IRQ line (fixed at compile time)
+
+typedef struct nt2s_sensor_t {
+	uint8_t uid[7];
+	uint8_t uid_length;						// 0: Entry unused
+	uint8_t type;							// DFRobot_PN532::eCardType_t, identified once per UID (GET_VERSION)
+	bool present;							// Found by the last search and not removed since
+	uint8_t failures;						// Consecutive failed accesses (read/write)
+	bool fast_read_unsupported;				// Tag rejected FAST_READ (0x3A, NAK) -> use READ only
+}nt2s_sensor_t;
+
 /* >> END: Symbols, Enums, Macros & Typedefs */
 
 
@@ -56,6 +64,7 @@ bool init_NT2S(void);
 
 /************************************************************************************
  * @brief: Search for THMS-NFC Sensor-Tag and get its informations.
+ *         Same as NT2S_search_sensors() > 0.
  * 
  * @return true: Sensor found.
  * @return false: No sensor found
@@ -63,12 +72,53 @@ bool init_NT2S(void);
 bool NT2S_search_sensor(void);
 
 /************************************************************************************
- * @brief Reads NFC-THMS-Sensor-Tag text message to "message_array" (char array). 
+ * @brief: Search for up to NT2S_MAX_SENSORS THMS-NFC Sensor-Tags (one InListPassiveTarget).
+ *         Known UIDs keep their index (and cached memory image, card type), new UIDs get a free
+ *         entry and are identified once with GET_VERSION (only NTAG21x are accepted).
+ *         If the selected sensor-tag is not present anymore, the first present one is selected.
+ * 
+ * @return Number of present sensor-tags
+ ************************************************************************************/
+uint8_t NT2S_search_sensors(void);
+
+/************************************************************************************
+ * @brief: Cause of the last failed tag access or search (see THMS_Retry for the classes).
+ * 
+ * @return DFRobot_PN532::STATUS_NO_TARGET: Tag removed / no sensor-tag in the field
+ ************************************************************************************/
+DFRobot_PN532::eStatus_t NT2S_last_status(void);
+
+/************************************************************************************
+ * @brief: Select the sensor-tag all following read/write functions act on.
+ * 
+ * @param index: 0 ... NT2S_MAX_SENSORS-1
+ * @return true: Selected
+ * @return false: No present sensor-tag with this index
+ ************************************************************************************/
+bool NT2S_select_sensor(uint8_t index);
+
+/************************************************************************************
+ * @brief: Index of the selected sensor-tag.
+ ************************************************************************************/
+uint8_t NT2S_selected_sensor(void);
+
+/************************************************************************************
+ * @brief: State of a sensor-tag (UID, presence, failure counter).
  * 
- * @param message_array: Pointer for read NDEF-Text as uint8_t array
- * @param max_length: Length of message_array
+ * @param index: 0 ... NT2S_MAX_SENSORS-1
+ * @return Pointer to the entry; NULL if index is invalid.
+ ************************************************************************************/
+const nt2s_sensor_t * NT2S_get_sensor(uint8_t index);
+
+/************************************************************************************
+ * @brief Reads NFC-THMS-Sensor-Tag text message to "message_array" (char array, '\0'-terminated).
+ *        Only the pages covering the NDEF message are read (TLV length). The first text
+ *        record is returned without language code.
+ * 
+ * @param message_array: Pointer for read NDEF-Text as uint8_t array (also used for the raw data)
+ * @param max_length: Length of message_array. Longer messages are rejected (not truncated).
  * @return true: Successful
- * @return false: Unsuccessful
+ * @return false: Unsuccessful; after a transient error NT2S_retry_after_ms() > 0
  ************************************************************************************/
 bool NT2S_read_ndef_text(uint8_t message_array[], uint8_t max_length);
 
@@ -78,7 +128,7 @@ bool NT2S_read_ndef_text(uint8_t message_array[], uint8_t max_length);
  * @param memory_data_array: Pointer for read raw data as uint8_t array
  * @param length: Length of message_array
  * @return true: Successful
- * @return false: Unsuccesful
+ * @return false: Unsuccesful; after a transient error NT2S_retry_after_ms() > 0
  ************************************************************************************/
 bool NT2S_read_raw(uint8_t memory_data_array[], uint8_t length); 
 
@@ -87,10 +137,48 @@ bool NT2S_read_raw(uint8_t memory_data_array[], uint8_t length);
  * 
  * @param do_instruction: Do-Instruction number as uint8_t.
  * @return true: Successful
- * @return false: Unsuccessful
+ * @return false: Unsuccessful; after a transient error NT2S_retry_after_ms() > 0
  ************************************************************************************/
 bool NT2S_set_instruction(uint8_t do_instruction);
 
+/************************************************************************************
+ * @brief: Backoff after a transient error of NT2S_read_ndef_text(), NT2S_read_raw() or
+ *         NT2S_set_instruction(). These functions never wait themselves: each call tries
+ *         every step once (worst case per call: one PN532 response timeout,
+ *         PN532_RESPONSE_TIMEOUT_MS). Calling the same function for the same sensor-tag
+ *         again continues the access with the remaining tries (read: 10, write: 5);
+ *         only when it is given up, it counts as failed access of the sensor-tag.
+ * 
+ * @return Time to wait before calling again (ms); 0: do not retry (success, permanent
+ *         error or no tries left)
+ ************************************************************************************/
+uint16_t NT2S_retry_after_ms(void);
+
+/************************************************************************************
+ * @brief Reads the current "Do:"-field of the sensor-tag with a single READ (pages 4-7).
+ *        Used to poll for completion: the tag replaces the written Do-instruction
+ *        as soon as it has processed it.
+ * 
+ * @param do_instruction_p: Pointer for read Do-instruction
+ * @return true: Successful
+ * @return false: Unsuccessful (tag not answering or no "Do:"-field)
+ ************************************************************************************/
+bool NT2S_read_do_instruction(uint8_t * do_instruction_p);
+
+/************************************************************************************
+ * @brief Copies the UID of the selected sensor-tag.
+ * 
+ * @param uid: Target array (7 bytes)
+ * @return Length of the UID (0: no tag selected yet)
+ ************************************************************************************/
+uint8_t NT2S_get_uid(uint8_t uid[]);
+
+/************************************************************************************
+ * @brief Enables/disables the ">>> "-debug lines printed by this library
+ *        (e.g. disabled while the bridge sends binary frames).
+ ************************************************************************************/
+void NT2S_set_debug_output(bool enable);
+
 /************************************************************************************
  * ToDo
  * @brief Überprüfen ob do_instruction eine bekannte Instroction ist (in nt2s_do_instructions_t definiert)
@@ -0,0 +1,128 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Binary_Frame.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Binäres Ausgabeformat der Bridge (COBS + CRC16).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <THMS_Binary_Frame.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+/* bframe_cobs_encode() and bframe_build() return uint8_t: a frame is one COBS block + delimiter */
+static_assert(BFRAME_MAX_FRAME_LENGTH <= 0xFF, "Frame length must fit into uint8_t");
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Prototypes (Internal Functions) */
+static uint8_t put_u16(uint8_t data[], uint16_t value);
+/* >> END: Prototypes */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+uint16_t bframe_crc16(const uint8_t data[], uint8_t length, uint16_t crc) {
+  for (uint8_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+uint8_t bframe_cobs_encode(const uint8_t src[], uint8_t length, uint8_t dst[]) {
+  uint8_t code_index = 0;   // Position of the code byte of the current block
+  uint8_t out = 1;
+  uint8_t code = 1;
+  for (uint8_t i = 0; i < length; i++) {
+    if (src[i] == 0x00) {
+      dst[code_index] = code;
+      code_index = out++;
+      code = 1;
+    } else {
+      dst[out++] = src[i];
+      code++;
+      if (code == 0xFF) {   // Block full (254 data bytes)
+        dst[code_index] = code;
+        code_index = out++;
+        code = 1;
+      }
+    }
+  }
+  dst[code_index] = code;
+  return out;
+}
+
+uint8_t bframe_build(uint8_t frame[], uint8_t type, uint8_t sequence_no, uint32_t time_ms,
+                     const uint8_t uid[], uint8_t uid_length, const uint8_t payload[], uint8_t payload_length) {
+  uint8_t raw[BFRAME_MAX_RAW_LENGTH];
+  uint8_t n = 0;
+  if (uid_length > BFRAME_MAX_UID_LENGTH) uid_length = BFRAME_MAX_UID_LENGTH;
+  if (payload_length > BFRAME_MAX_PAYLOAD) payload_length = BFRAME_MAX_PAYLOAD;
+  raw[n++] = type;
+  raw[n++] = sequence_no;
+  n += put_u16(&raw[n], (uint16_t)time_ms);
+  n += put_u16(&raw[n], (uint16_t)(time_ms >> 16));
+  raw[n++] = uid_length;
+  if (uid_length > 0) memcpy(&raw[n], uid, uid_length);
+  n += uid_length;
+  if (payload_length > 0) memcpy(&raw[n], payload, payload_length);
+  n += payload_length;
+  n += put_u16(&raw[n], bframe_crc16(raw, n, 0xFFFF));
+  uint8_t frame_length = bframe_cobs_encode(raw, n, frame);
+  frame[frame_length++] = BFRAME_DELIMITER;
+  return frame_length;
+}
+
+uint8_t bframe_put_measurement(uint8_t payload[], const thms_message_t * measurement) {
+  uint8_t n = 0;
+  payload[n++] = measurement->do_instruction;
+  n += put_u16(&payload[n], measurement->no);
+  n += put_u16(&payload[n], measurement->ss);
+  n += put_u16(&payload[n], measurement->ms);
+  n += put_u16(&payload[n], measurement->rsqpb);
+  return n;
+}
+
+uint8_t bframe_put_log_record(uint8_t payload[], const mlog_record_t * record) {
+  uint8_t n = 0;
+  n += put_u16(&payload[n], (uint16_t)record->time_ms);
+  n += put_u16(&payload[n], (uint16_t)(record->time_ms >> 16));
+  n += put_u16(&payload[n], record->uid_hash);
+  n += put_u16(&payload[n], record->no);
+  n += put_u16(&payload[n], record->ss);
+  n += put_u16(&payload[n], record->ms);
+  n += put_u16(&payload[n], record->rsqpb);
+  return n;
+}
+
+uint8_t bframe_put_profile_counter(uint8_t payload[], uint8_t point, const prof_counter_t * counter) {
+  uint8_t n = 0;
+  payload[n++] = point;
+  n += put_u16(&payload[n], counter->count);
+  n += put_u16(&payload[n], counter->retries);
+  n += put_u16(&payload[n], (uint16_t)counter->total_us);
+  n += put_u16(&payload[n], (uint16_t)(counter->total_us >> 16));
+  n += put_u16(&payload[n], (uint16_t)counter->max_us);
+  n += put_u16(&payload[n], (uint16_t)(counter->max_us >> 16));
+  return n;
+}
+/* >> END: External Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal (Static) Functions */
+static uint8_t put_u16(uint8_t data[], uint16_t value) {
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+  return 2;
+}
+/* >> END: Internal (Static) Functions */
@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Binary_Frame.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Binäres Ausgabeformat der Bridge (alternativ zum Textprotokoll).
+ *             Jeder Datensatz wird als COBS-kodierter Frame mit CRC16 gesendet
+ *             und mit 0x00 abgeschlossen:
+ *               COBS( Typ | Seq | millis (4, LE) | UID-Länge | UID | Nutzdaten | CRC16 (LE) ) 0x00
+ *             CRC16: CCITT-FALSE (Poly 0x1021, Init 0xFFFF) über alle Bytes vor der CRC.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_BINARY_FRAME_H_
+#define _THMS_BINARY_FRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <THMS_Message.h>
+#include <THMS_Measurement_Log.h>
+#include <THMS_Profile.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define BFRAME_MAX_UID_LENGTH       7
+#define BFRAME_MAX_PAYLOAD          48
+#define BFRAME_HEADER_LENGTH        (1 + 1 + 4 + 1)   // Type, Seq, millis, UID length (+ UID)
+#define BFRAME_MAX_RAW_LENGTH       (BFRAME_HEADER_LENGTH + BFRAME_MAX_UID_LENGTH + BFRAME_MAX_PAYLOAD + 2)
+#define BFRAME_MAX_FRAME_LENGTH     (BFRAME_MAX_RAW_LENGTH + 2)   // + COBS code byte + delimiter (frame < 254 bytes)
+#define BFRAME_DELIMITER            0x00
+
+typedef enum {
+	BFRAME_TYPE_MEASUREMENT			= 0x01,	// Payload: Do, No, SS, MS, RSQPB of a thms_message_t
+	BFRAME_TYPE_TEXT				= 0x02,	// Payload: NDEF text which is no measurement (e.g. config answer)
+	BFRAME_TYPE_INFO				= 0x03,	// Payload: Info level (1 Byte) + info text (">>> "-lines in text mode)
+	BFRAME_TYPE_LOG_RECORD			= 0x04,	// Payload: mlog_record_t; empty payload: end of a log dump
+	BFRAME_TYPE_PROFILE				= 0x05,	// Payload: prof_point_t + prof_counter_t (only with THMS_PROFILING)
+	BFRAME_TYPE_ERROR_COUNTERS		= 0x06,	// Payload: uint16 per DFRobot_PN532::eStatus_t 1..STATUS_COUNT-1
+	BFRAME_TYPE_COMMAND				= 0x07	// Payload: report, seq, instruction, waiting commands, error bits (uint16)
+}bframe_type_t;
+
+/* Answer to a serial instruction. Sent little endian, 6 bytes. */
+#define BFRAME_COMMAND_LENGTH       6
+
+/* Measurement "Do:01;No:1;SS:123;MS:456;RSQPB:1203;". Sent little endian, 9 bytes. */
+#define BFRAME_MEASUREMENT_LENGTH   9
+#define BFRAME_PROFILE_LENGTH       13
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief CRC-16/CCITT-FALSE. Start with crc = 0xFFFF.
+ ************************************************************************************/
+uint16_t bframe_crc16(const uint8_t data[], uint8_t length, uint16_t crc);
+
+/************************************************************************************
+ * @brief COBS encoding (without delimiter). dst needs length + 1 + length/254 bytes.
+ *
+ * @param length: At most 253, so the encoded length fits into the return value
+ * @return Length of encoded data
+ ************************************************************************************/
+uint8_t bframe_cobs_encode(const uint8_t src[], uint8_t length, uint8_t dst[]);
+
+/************************************************************************************
+ * @brief Builds a complete frame (COBS encoded, CRC, delimiter).
+ *
+ * @param frame: Target array with BFRAME_MAX_FRAME_LENGTH bytes
+ * @param type: bframe_type_t
+ * @param sequence_no: Frame sequence number (wraps)
+ * @param time_ms: millis() timestamp
+ * @param uid: Tag UID (may be NULL if uid_length == 0)
+ * @param payload_length: Longer payloads are truncated to BFRAME_MAX_PAYLOAD
+ * @return Length of the frame incl. delimiter
+ ************************************************************************************/
+uint8_t bframe_build(uint8_t frame[], uint8_t type, uint8_t sequence_no, uint32_t time_ms,
+                     const uint8_t uid[], uint8_t uid_length, const uint8_t payload[], uint8_t payload_length);
+
+/************************************************************************************
+ * @brief Serializes a measurement to BFRAME_MEASUREMENT_LENGTH bytes (little endian).
+ *
+ * @return BFRAME_MEASUREMENT_LENGTH
+ ************************************************************************************/
+uint8_t bframe_put_measurement(uint8_t payload[], const thms_message_t * measurement);
+
+/************************************************************************************
+ * @brief Serializes a log record to MLOG_RECORD_LENGTH bytes (little endian).
+ *
+ * @return MLOG_RECORD_LENGTH
+ ************************************************************************************/
+uint8_t bframe_put_log_record(uint8_t payload[], const mlog_record_t * record);
+
+/************************************************************************************
+ * @brief Serializes a profiling counter to BFRAME_PROFILE_LENGTH bytes (little endian):
+ *        point, count, retries, total_us, max_us.
+ *
+ * @return BFRAME_PROFILE_LENGTH
+ ************************************************************************************/
+uint8_t bframe_put_profile_counter(uint8_t payload[], uint8_t point, const prof_counter_t * counter);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_BINARY_FRAME_H_ */
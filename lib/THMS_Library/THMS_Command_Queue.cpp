@@ -0,0 +1,45 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Command_Queue.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ringpuffer für geprüfte serielle Befehle mit Sequenznummern.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <THMS_Command_Queue.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+void cmdq_init(cmdq_t * queue) {
+  queue->head = 0;
+  queue->tail = 0;
+  queue->next_sequence_no = 0;
+}
+
+uint8_t cmdq_take_sequence_no(cmdq_t * queue) {
+  return queue->next_sequence_no++;
+}
+
+bool cmdq_push(cmdq_t * queue, const cmdq_command_t * command) {
+  uint8_t next = (uint8_t)((queue->head + 1) & CMDQ_MASK);
+  if (next == queue->tail) return false;
+  queue->commands[queue->head] = *command;
+  queue->head = next;
+  return true;
+}
+
+bool cmdq_pop(cmdq_t * queue, cmdq_command_t * command) {
+  if (queue->tail == queue->head) return false;
+  *command = queue->commands[queue->tail];
+  queue->tail = (uint8_t)((queue->tail + 1) & CMDQ_MASK);
+  return true;
+}
+
+uint8_t cmdq_count(const cmdq_t * queue) {
+  return (uint8_t)((queue->head - queue->tail) & CMDQ_MASK);
+}
+/* >> END: External Functions */
@@ -0,0 +1,82 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Command_Queue.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Warteschlange für serielle Befehle. Jeder empfangene Befehl
+ *             bekommt eine fortlaufende Sequenznummer und wird geprüft
+ *             abgelegt; ausgeführt wird in Empfangsreihenfolge, sobald die
+ *             FSM frei ist. So überschreibt ein neuer Befehl keine laufende
+ *             Arbeit und der PC kann mehrere Befehle direkt nacheinander senden.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_COMMAND_QUEUE_H_
+#define _THMS_COMMAND_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define CMDQ_SIZE                   8     // Must be a power of two (<= 128)
+#define CMDQ_MASK                   (CMDQ_SIZE - 1)
+
+/* One parsed command (5 bytes instead of the whole line) */
+typedef struct cmdq_command_t {
+	uint8_t sequence_no;			// From cmdq_take_sequence_no()
+	char code;						// Instruction letter (upper case)
+	uint8_t option;					// Command specific (e.g. on/off/toggle)
+	uint16_t value;					// Command specific (e.g. interval in s)
+}cmdq_command_t;
+
+typedef struct cmdq_t {
+	uint8_t head;					// Next free entry
+	uint8_t tail;					// Oldest entry
+	uint8_t next_sequence_no;
+	cmdq_command_t commands[CMDQ_SIZE];
+}cmdq_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Empties the queue; sequence numbers start at 0.
+ ************************************************************************************/
+void cmdq_init(cmdq_t * queue);
+
+/************************************************************************************
+ * @brief Sequence number for the next received command (0..255, wraps). Also taken
+ *        by rejected commands, so every line the host sent has its own number.
+ ************************************************************************************/
+uint8_t cmdq_take_sequence_no(cmdq_t * queue);
+
+/************************************************************************************
+ * @brief Appends a command.
+ *
+ * @return true: Queued
+ * @return false: Queue full (CMDQ_SIZE - 1 commands waiting)
+ ************************************************************************************/
+bool cmdq_push(cmdq_t * queue, const cmdq_command_t * command);
+
+/************************************************************************************
+ * @brief Takes the oldest command.
+ *
+ * @return false: Queue empty
+ ************************************************************************************/
+bool cmdq_pop(cmdq_t * queue, cmdq_command_t * command);
+
+/************************************************************************************
+ * @brief Number of waiting commands.
+ ************************************************************************************/
+uint8_t cmdq_count(const cmdq_t * queue);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_COMMAND_QUEUE_H_ */
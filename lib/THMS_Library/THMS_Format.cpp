@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Format.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Hex-/Dezimalausgabe und Zahlen-Parser ohne printf/scanf.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <THMS_Format.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static const char hex_digits_m[16] PROGMEM = {
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+static const uint32_t powers_of_10_m[FMT_UDEC_MAX_LENGTH - 1] PROGMEM = {
+  1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL
+};
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+uint8_t fmt_hex(char text[], uint32_t value, uint8_t digits) {
+  if (digits == 0) {   // As many as needed, at least one
+    digits = 1;
+    while ((digits < FMT_HEX_MAX_LENGTH) && ((value >> (4*digits)) != 0)) digits++;
+  }
+  if (digits > FMT_HEX_MAX_LENGTH) digits = FMT_HEX_MAX_LENGTH;
+  for (uint8_t i = digits; i > 0; i--) {
+    text[i - 1] = pgm_read_byte(&hex_digits_m[value & 0x0F]);
+    value >>= 4;
+  }
+  return digits;
+}
+
+/* Each digit: count how often the power of ten fits (at most 9 subtractions) */
+uint8_t fmt_udec(char text[], uint32_t value) {
+  uint8_t length = 0;
+  for (uint8_t i = 0; i < (FMT_UDEC_MAX_LENGTH - 1); i++) {
+    uint32_t power = pgm_read_dword(&powers_of_10_m[i]);
+    char digit = '0';
+    while (value >= power) {
+      value -= power;
+      digit++;
+    }
+    if ((digit != '0') || (length > 0)) text[length++] = digit;   // No leading zeros
+  }
+  text[length++] = '0' + (uint8_t)value;
+  return length;
+}
+
+void fmt_print_hex(Print * out, uint32_t value, uint8_t digits) {
+  char text[FMT_HEX_MAX_LENGTH];
+  out->write((const uint8_t *)text, fmt_hex(text, value, digits));
+}
+
+void fmt_print_udec(Print * out, uint32_t value) {
+  char text[FMT_UDEC_MAX_LENGTH];
+  out->write((const uint8_t *)text, fmt_udec(text, value));
+}
+
+void fmt_print_hex_bytes(Print * out, const uint8_t data[], uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) fmt_print_hex(out, data[i], 2);
+}
+
+void fmt_print_key_udec(Print * out, const __FlashStringHelper * key, uint32_t value) {
+  out->print(key);
+  out->write(':');
+  fmt_print_udec(out, value);
+  out->write(';');
+}
+
+void fmt_print_key_hex(Print * out, const __FlashStringHelper * key, uint32_t value, uint8_t digits) {
+  out->print(key);
+  out->write(':');
+  fmt_print_hex(out, value, digits);
+  out->write(';');
+}
+
+fmt_result_t fmt_parse_uint(const char text[], uint8_t base, uint32_t max, uint32_t * value, const char ** end) {
+  const char * p = text;
+  if ((base == 16) && (p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X')) && (fmt_digit_value(p[2], 16) != 0xFF)) p += 2;
+  uint32_t number = 0;
+  const char * first_digit = p;
+  for (uint8_t digit; (digit = fmt_digit_value(*p, base)) != 0xFF; p++) {
+    if ((digit > max) || (number > ((max - digit) / base))) return FMT_OUT_OF_RANGE;   // number*base + digit > max
+    number = number*base + digit;
+  }
+  if (p == first_digit) return FMT_NO_DIGITS;
+  if (end != NULL) *end = p;
+  else if (*p != '\0') return FMT_INVALID;
+  *value = number;
+  return FMT_OK;
+}
+
+uint8_t fmt_digit_value(char c, uint8_t base) {
+  if ((c >= '0') && (c <= '9')) return c - '0';
+  if (base == 16) {
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+  }
+  return 0xFF;
+}
+/* >> END: External Functions */
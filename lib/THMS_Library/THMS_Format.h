@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Format.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Zahlen ausgeben und einlesen ohne sprintf/sscanf (spart auf dem
+ *             AVR mehrere KB Flash für vfprintf/vfscanf). Hex über eine
+ *             Zifferntabelle, Dezimal über eine Tabelle der Zehnerpotenzen
+ *             (keine 32-Bit-Division), "Schlüssel:Wert;"-Ausgabe und ein
+ *             Parser, der Wertebereich und Fehler meldet.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_FORMAT_H_
+#define _THMS_FORMAT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Arduino.h"
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define FMT_UDEC_MAX_LENGTH         10     // 4294967295
+#define FMT_HEX_MAX_LENGTH          8      // FFFFFFFF
+
+typedef enum {
+	FMT_OK						= 0,
+	FMT_NO_DIGITS,				// Text does not start with a digit
+	FMT_OUT_OF_RANGE,			// Value > max
+	FMT_INVALID					// Other characters after the number (only if end == NULL)
+}fmt_result_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Hex digits (upper case) of value, without '\0'.
+ *
+ * @param digits: Number of digits with leading zeros (e.g. 2 for a byte);
+ *                0: as many as needed
+ * @return Number of characters written (<= FMT_HEX_MAX_LENGTH)
+ ************************************************************************************/
+uint8_t fmt_hex(char text[], uint32_t value, uint8_t digits);
+
+/************************************************************************************
+ * @brief Decimal digits of value, without '\0'.
+ *
+ * @return Number of characters written (<= FMT_UDEC_MAX_LENGTH)
+ ************************************************************************************/
+uint8_t fmt_udec(char text[], uint32_t value);
+
+/************************************************************************************
+ * @brief Same as fmt_hex()/fmt_udec(), written to out.
+ ************************************************************************************/
+void fmt_print_hex(Print * out, uint32_t value, uint8_t digits);
+void fmt_print_udec(Print * out, uint32_t value);
+
+/************************************************************************************
+ * @brief Bytes as hex, two digits each (e.g. UID "045A1B923C6E80").
+ ************************************************************************************/
+void fmt_print_hex_bytes(Print * out, const uint8_t data[], uint8_t length);
+
+/************************************************************************************
+ * @brief "key:value;" with decimal or hex value (e.g. "No:1;", "UH:0CA5;").
+ ************************************************************************************/
+void fmt_print_key_udec(Print * out, const __FlashStringHelper * key, uint32_t value);
+void fmt_print_key_hex(Print * out, const __FlashStringHelper * key, uint32_t value, uint8_t digits);
+
+/************************************************************************************
+ * @brief Reads an unsigned number (base 16 also accepts "0x"/"0X" in front).
+ *
+ * @param text: Number; parsing stops at the first character that is no digit
+ * @param base: 10 or 16
+ * @param max: Largest allowed value
+ * @param value: Result (unchanged on error)
+ * @param end: First character after the number. NULL: the number has to end the text.
+ * @return FMT_OK or the reason why the text is no valid number
+ ************************************************************************************/
+fmt_result_t fmt_parse_uint(const char text[], uint8_t base, uint32_t max, uint32_t * value, const char ** end);
+
+/************************************************************************************
+ * @brief Value of one digit.
+ * @return 0..base-1; 0xFF if c is no valid digit for base (10 or 16).
+ ************************************************************************************/
+uint8_t fmt_digit_value(char c, uint8_t base);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_FORMAT_H_ */
@@ -0,0 +1,70 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Line_Buffer.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ringpuffer für zeilenbasierte serielle Eingaben.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <THMS_Line_Buffer.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+void line_buffer_init(line_buffer_t * buffer) {
+  buffer->head = 0;
+  buffer->tail = 0;
+  buffer->overflow = false;
+  buffer->skip_to_line_end = false;
+}
+
+bool line_buffer_put(line_buffer_t * buffer, uint8_t data) {
+  uint8_t head = buffer->head;
+  uint8_t next = (uint8_t)((head + 1) & LINE_BUFFER_MASK);
+  if (next == buffer->tail) {
+    buffer->overflow = true;
+    return false;
+  }
+  buffer->data[head] = data;
+  buffer->head = next;    // Publish only after the byte is stored
+  return true;
+}
+
+int line_buffer_get_line(line_buffer_t * buffer, char line[], uint8_t line_size) {
+  while (true) {
+    uint8_t tail = buffer->tail;
+    uint8_t head = buffer->head;
+    uint8_t line_end = tail;
+    while ((line_end != head) && (buffer->data[line_end] != '\n')) {
+      line_end = (uint8_t)((line_end + 1) & LINE_BUFFER_MASK);
+    }
+    if (line_end == head) {
+      if (((head + 1) & LINE_BUFFER_MASK) == tail) {   // Full without line end: discard
+        buffer->tail = head;
+        buffer->skip_to_line_end = true;
+        return LINE_BUFFER_LINE_TOO_LONG;
+      }
+      return LINE_BUFFER_NO_LINE;
+    }
+    if (buffer->skip_to_line_end) {                   // End of an already discarded line
+      buffer->skip_to_line_end = false;
+      buffer->tail = (uint8_t)((line_end + 1) & LINE_BUFFER_MASK);
+      continue;
+    }
+    uint8_t length = 0;
+    bool too_long = false;
+    for (uint8_t i = tail; i != line_end; i = (uint8_t)((i + 1) & LINE_BUFFER_MASK)) {
+      char c = (char)buffer->data[i];
+      if (c == '\r') continue;
+      if (length < (line_size - 1)) line[length++] = c;
+      else too_long = true;
+    }
+    line[length] = '\0';
+    buffer->tail = (uint8_t)((line_end + 1) & LINE_BUFFER_MASK);
+    return too_long ? LINE_BUFFER_LINE_TOO_LONG : length;
+  }
+}
+/* >> END: External Functions */
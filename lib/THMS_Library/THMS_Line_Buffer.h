@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Line_Buffer.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ringpuffer für zeilenbasierte serielle Eingaben. Bytes werden
+ *             einzeln abgelegt, sobald sie ankommen (auch aus einer ISR
+ *             heraus: ein Produzent, ein Konsument, 8-Bit-Indizes), und
+ *             vollständige Zeilen ('\n') werden NUL-terminiert entnommen.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_LINE_BUFFER_H_
+#define _THMS_LINE_BUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define LINE_BUFFER_SIZE            128   // Must be a power of two (<= 256)
+#define LINE_BUFFER_MASK            (LINE_BUFFER_SIZE - 1)
+
+#define LINE_BUFFER_NO_LINE         (-1)  // No complete line available
+#define LINE_BUFFER_LINE_TOO_LONG   (-2)  // Line longer than the target array; line was discarded
+
+typedef struct line_buffer_t {
+	volatile uint8_t head;			// Written by the producer only
+	volatile uint8_t tail;			// Written by the consumer only
+	uint8_t data[LINE_BUFFER_SIZE];
+	volatile bool overflow;			// Byte(s) dropped because the buffer was full
+	bool skip_to_line_end;			// Consumer: rest of a discarded line is still to come
+}line_buffer_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Empties the buffer.
+ ************************************************************************************/
+void line_buffer_init(line_buffer_t * buffer);
+
+/************************************************************************************
+ * @brief Stores one received byte (producer side, ISR safe).
+ *
+ * @return true: Stored
+ * @return false: Buffer full, byte dropped
+ ************************************************************************************/
+bool line_buffer_put(line_buffer_t * buffer, uint8_t data);
+
+/************************************************************************************
+ * @brief Takes the oldest complete line (consumer side). '\r' and '\n' are removed,
+ *        the line is NUL-terminated. Never blocks.
+ *
+ * @param line: Target array
+ * @param line_size: Size of line incl. NUL termination
+ * @return Length of the line (>= 0), LINE_BUFFER_NO_LINE or LINE_BUFFER_LINE_TOO_LONG
+ ************************************************************************************/
+int line_buffer_get_line(line_buffer_t * buffer, char line[], uint8_t line_size);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_LINE_BUFFER_H_ */
@@ -0,0 +1,118 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Log.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Informationsstrings mit Info-Level und Formatierung aus dem Flash.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <stdarg.h>
+#include <THMS_Log.h>
+#include <THMS_Format.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+/* Collects the text of one binary info frame */
+class log_text_buffer_t : public Print {
+public:
+  size_t write(uint8_t c) {
+    if (length >= LOG_MAX_TEXT_LENGTH) return 0;   // Truncated like the frame payload
+    text[length++] = (char)c;
+    return 1;
+  }
+  using Print::write;
+  char text[LOG_MAX_TEXT_LENGTH];
+  uint8_t length = 0;
+};
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static Print * serial_m = NULL;
+static log_frame_output_t frame_output_m = NULL;
+static uint8_t levels_m = THMS_LOG_LEVELS;
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Functions (Deklarationen/Prototypen)*/
+static void format_P(Print * out, PGM_P format, va_list args);
+/* >> END: Internal Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+void log_begin(Print * serial) {
+  serial_m = serial;
+}
+
+void log_set_frame_output(log_frame_output_t frame_output) {
+  frame_output_m = frame_output;
+}
+
+void log_set_levels(uint8_t levels) {
+  levels_m = levels & (THMS_LOG_LEVELS);
+}
+
+uint8_t log_levels(void) {
+  return levels_m;
+}
+
+bool log_enabled(uint8_t level) {
+  return (level & levels_m) != 0;
+}
+
+void log_print_P(uint8_t level, PGM_P format, ...) {
+  va_list args;
+  va_start(args, format);
+  if (frame_output_m != NULL) {
+    log_text_buffer_t buffer;
+    format_P(&buffer, format, args);
+    frame_output_m(level, buffer.text, buffer.length);
+  } else if (serial_m != NULL) {
+    serial_m->print(F(">>> "));
+    format_P(serial_m, format, args);
+    serial_m->println();
+  }
+  va_end(args);
+}
+/* >> END: External Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Functions */
+static void format_P(Print * out, PGM_P format, va_list args) {
+  char c;
+  while ((c = pgm_read_byte(format++)) != '\0') {
+    if (c != '%') {out->write(c); continue;}
+    c = pgm_read_byte(format++);
+    bool is_long = (c == 'l');
+    if (is_long) c = pgm_read_byte(format++);
+    switch (c) {
+      case 'u':
+        fmt_print_udec(out, is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned int));
+        break;
+      case 'x':
+        fmt_print_hex(out, is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned int), 0);
+        break;
+      case 's':
+        out->print(va_arg(args, const char *));
+        break;
+      case '%':
+        out->write('%');
+        break;
+      case '\0':
+        return;   // '%' at the end of the format
+      default:    // Unknown conversion: printed as it is
+        out->write('%');
+        out->write(c);
+        break;
+    }
+  }
+}
+/* >> END: Internal Functions */
@@ -0,0 +1,89 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Log.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Informationsstrings (">>> ...") mit Info-Level. Welche Level
+ *             überhaupt übersetzt werden, legt -DTHMS_LOG_LEVELS fest (siehe
+ *             platformio.ini); Meldungen anderer Level erzeugen keinen Code.
+ *             Zur Laufzeit wird mit log_set_levels() weiter eingeschränkt.
+ *             Das Format liegt im Flash und wird erst formatiert, wenn das
+ *             Level aktiv ist, direkt in die Ausgabe (kein Zwischenpuffer).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_LOG_H_
+#define _THMS_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Arduino.h"
+#include <THMS_Binary_Frame.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+// Info levels. Each level has own bit (also first byte of the binary info frame).
+typedef enum {
+	LOG_ERROR					= (0x1 << 0),	// Info about errors
+	LOG_STANDARD				= (0x1 << 1),	// Standard infos
+	LOG_FSM_STATE				= (0x1 << 2),	// Info about actual FSM-State (every FSM step)
+	LOG_NEXT_MEASUREMENT		= (0x1 << 3),	// Time to next measurement in s (every second)
+	LOG_EXTENDED				= (0x1 << 4),	// Some extended standard info
+	LOG_ALL						= 0x1F
+}log_level_t;
+
+#ifndef THMS_LOG_LEVELS
+#define THMS_LOG_LEVELS       (LOG_ERROR | LOG_STANDARD | LOG_EXTENDED)   // Compiled in (build flag overrides)
+#endif
+
+#define LOG_MAX_TEXT_LENGTH   (BFRAME_MAX_PAYLOAD - 1)   // Binary info frame: level + text
+
+/* Text of one message for the binary output (not 0-terminated) */
+typedef void (*log_frame_output_t)(uint8_t level, const char text[], uint8_t length);
+
+/* true if messages of this level are compiled in and enabled. Constant false for levels
+   outside of THMS_LOG_LEVELS, so the code behind it is removed by the compiler. */
+#define LOG_ACTIVE(level)     ((((level) & (THMS_LOG_LEVELS)) != 0) && log_enabled(level))
+
+/* Prints ">>> " + formatted message, e.g. LOG_MSG(LOG_ERROR, "ERROR No: 0x%x", error_no).
+   The arguments are only evaluated and formatted if the level is active. */
+#define LOG_MSG(level, format, ...) \
+	do { if (LOG_ACTIVE(level)) log_print_P((level), PSTR(format), ##__VA_ARGS__); } while (0)
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Selects the output of the messages.
+ *
+ * @param serial: Text lines (">>> " + message + "\r\n")
+ * @param frame_output: Binary output instead of text lines (NULL: text lines)
+ ************************************************************************************/
+void log_begin(Print * serial);
+void log_set_frame_output(log_frame_output_t frame_output);
+
+/************************************************************************************
+ * @brief Enables the given levels at runtime (bit mask of log_level_t). Levels that are
+ *        not compiled in (THMS_LOG_LEVELS) stay off.
+ ************************************************************************************/
+void log_set_levels(uint8_t levels);
+uint8_t log_levels(void);
+bool log_enabled(uint8_t level);
+
+/************************************************************************************
+ * @brief Formats and prints one message. Use LOG_MSG() instead.
+ *
+ * @param format: Format in flash. Conversions: %u/%lu (unsigned int/long, decimal),
+ *                %x/%lx (hex, upper case), %s (string in RAM), %% ('%')
+ ************************************************************************************/
+void log_print_P(uint8_t level, PGM_P format, ...);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_LOG_H_ */
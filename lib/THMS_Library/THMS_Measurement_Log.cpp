@@ -0,0 +1,139 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Measurement_Log.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ringpuffer der letzten Messungen (SRAM, optional EEPROM).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <THMS_Measurement_Log.h>
+#include <THMS_Binary_Frame.h>
+#if MLOG_EEPROM_SPILL
+#include <EEPROM.h>
+#endif
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#if MLOG_EEPROM_SPILL
+#define MLOG_EEPROM_RECORDS         (MLOG_EEPROM_SIZE / MLOG_RECORD_LENGTH)
+static_assert(MLOG_EEPROM_BASE + MLOG_EEPROM_SIZE <= E2END + 1, "Log region outside of the EEPROM");
+#else
+#define MLOG_EEPROM_RECORDS         0
+#endif
+
+static_assert(sizeof(mlog_record_t) == MLOG_RECORD_LENGTH, "mlog_record_t must be packed");
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+// Oldest records are in the EEPROM (if MLOG_EEPROM_SPILL), newer ones in SRAM.
+static mlog_record_t ram_records_m[MLOG_RAM_RECORDS];
+static uint8_t ram_first_m = 0;          // Index of the oldest SRAM record
+static uint8_t ram_count_m = 0;
+static uint16_t eeprom_first_m = 0;      // Slot of the oldest EEPROM record
+static uint16_t eeprom_count_m = 0;
+static uint16_t dropped_m = 0;
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Prototypes (Internal Functions) */
+#if MLOG_EEPROM_SPILL
+/************************************************************************************
+ * EEPROM slot <-> record. update() only writes changed bytes (EEPROM wear).
+ ************************************************************************************/
+static void eeprom_write_record(uint16_t slot, const mlog_record_t * record);
+static void eeprom_read_record(uint16_t slot, mlog_record_t * record);
+#endif
+/* >> END: Prototypes */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+void mlog_clear(void) {
+  ram_first_m = 0;
+  ram_count_m = 0;
+  eeprom_first_m = 0;
+  eeprom_count_m = 0;
+  dropped_m = 0;
+}
+
+void mlog_add(uint32_t time_ms, const uint8_t uid[], uint8_t uid_length, const thms_message_t * measurement) {
+  if (ram_count_m == MLOG_RAM_RECORDS) {
+#if MLOG_EEPROM_SPILL
+    if (eeprom_count_m == MLOG_EEPROM_RECORDS) {
+      eeprom_first_m = (eeprom_first_m + 1) % MLOG_EEPROM_RECORDS;
+      eeprom_count_m--;
+      if (dropped_m < 0xFFFF) dropped_m++;
+    }
+    eeprom_write_record((eeprom_first_m + eeprom_count_m) % MLOG_EEPROM_RECORDS, &ram_records_m[ram_first_m]);
+    eeprom_count_m++;
+#else
+    if (dropped_m < 0xFFFF) dropped_m++;
+#endif
+    ram_first_m = (ram_first_m + 1) % MLOG_RAM_RECORDS;
+    ram_count_m--;
+  }
+  mlog_record_t * record = &ram_records_m[(ram_first_m + ram_count_m) % MLOG_RAM_RECORDS];
+  record->time_ms = time_ms;
+  record->uid_hash = mlog_uid_hash(uid, uid_length);
+  record->no = measurement->no;
+  record->ss = measurement->ss;
+  record->ms = measurement->ms;
+  record->rsqpb = measurement->rsqpb;
+  ram_count_m++;
+}
+
+uint16_t mlog_count(void) {
+  return eeprom_count_m + ram_count_m;
+}
+
+uint16_t mlog_capacity(void) {
+  return MLOG_EEPROM_RECORDS + MLOG_RAM_RECORDS;
+}
+
+uint16_t mlog_dropped(void) {
+  return dropped_m;
+}
+
+bool mlog_get(uint16_t index, mlog_record_t * record) {
+#if MLOG_EEPROM_SPILL
+  if (index < eeprom_count_m) {
+    eeprom_read_record((eeprom_first_m + index) % MLOG_EEPROM_RECORDS, record);
+    return true;
+  }
+#endif
+  index -= eeprom_count_m;
+  if (index >= ram_count_m) return false;
+  *record = ram_records_m[(ram_first_m + index) % MLOG_RAM_RECORDS];
+  return true;
+}
+
+uint16_t mlog_uid_hash(const uint8_t uid[], uint8_t uid_length) {
+  return bframe_crc16(uid, uid_length, 0xFFFF);
+}
+/* >> END: External Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal (Static) Functions */
+#if MLOG_EEPROM_SPILL
+static void eeprom_write_record(uint16_t slot, const mlog_record_t * record) {
+  const uint8_t * data = (const uint8_t *)record;
+  int address = MLOG_EEPROM_BASE + slot*MLOG_RECORD_LENGTH;
+  for (uint8_t i = 0; i < MLOG_RECORD_LENGTH; i++) EEPROM.update(address + i, data[i]);
+}
+
+static void eeprom_read_record(uint16_t slot, mlog_record_t * record) {
+  uint8_t * data = (uint8_t *)record;
+  int address = MLOG_EEPROM_BASE + slot*MLOG_RECORD_LENGTH;
+  for (uint8_t i = 0; i < MLOG_RECORD_LENGTH; i++) data[i] = EEPROM.read(address + i);
+}
+#endif
+/* >> END: Internal (Static) Functions */
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Measurement_Log.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ringpuffer der letzten Messungen (millis, UID-Hash, Messwerte),
+ *             damit der PC die Messungen gesammelt abholen kann, statt
+ *             dauerhaft mitzulesen. Die neuesten Datensätze liegen im SRAM;
+ *             mit -DMLOG_EEPROM_SPILL=1 werden ältere Datensätze in einen
+ *             EEPROM-Bereich (MLOG_EEPROM_BASE/MLOG_EEPROM_SIZE) ausgelagert,
+ *             statt überschrieben zu werden.
+ *             Das Log ist flüchtig, auch der EEPROM-Teil: die Indizes liegen
+ *             nur im SRAM, nach einem Reset ist das Log leer.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_MEASUREMENT_LOG_H_
+#define _THMS_MEASUREMENT_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <THMS_Message.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define MLOG_RAM_RECORDS            16     // Records in SRAM (14 bytes each)
+/* 1: Oldest SRAM records are moved to the EEPROM instead of being overwritten. Each move
+   writes up to 14 EEPROM bytes (~3.3 ms each), so mlog_add() then blocks up to ~46 ms. */
+#ifndef MLOG_EEPROM_SPILL
+#define MLOG_EEPROM_SPILL           0
+#endif
+#ifndef MLOG_EEPROM_BASE
+#define MLOG_EEPROM_BASE            0      // First EEPROM address of the log region
+#endif
+#ifndef MLOG_EEPROM_SIZE
+#define MLOG_EEPROM_SIZE            1024   // Bytes of the log region (default: whole ATmega328 EEPROM)
+#endif
+
+/* One measurement, packed (14 bytes, little endian on AVR and host) */
+typedef struct __attribute__((packed)) mlog_record_t {
+	uint32_t time_ms;				// millis() when the measurement was read
+	uint16_t uid_hash;				// CRC16 of the UID (mlog_uid_hash)
+	uint16_t no;
+	uint16_t ss;
+	uint16_t ms;
+	uint16_t rsqpb;
+}mlog_record_t;
+#define MLOG_RECORD_LENGTH          14
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Empties the log (EEPROM content is not erased, only forgotten).
+ ************************************************************************************/
+void mlog_clear(void);
+
+/************************************************************************************
+ * @brief Appends a measurement. If the log is full, the oldest record is dropped.
+ *
+ * @param time_ms: millis() timestamp
+ * @param uid: UID of the sensor-tag
+ * @param measurement: Parsed message (only the measurement fields are stored)
+ ************************************************************************************/
+void mlog_add(uint32_t time_ms, const uint8_t uid[], uint8_t uid_length, const thms_message_t * measurement);
+
+/************************************************************************************
+ * @brief Number of records in the log.
+ ************************************************************************************/
+uint16_t mlog_count(void);
+
+/************************************************************************************
+ * @brief Maximal number of records (SRAM + EEPROM).
+ ************************************************************************************/
+uint16_t mlog_capacity(void);
+
+/************************************************************************************
+ * @brief Number of records dropped because the log was full (since mlog_clear).
+ ************************************************************************************/
+uint16_t mlog_dropped(void);
+
+/************************************************************************************
+ * @brief Reads a record.
+ *
+ * @param index: 0 = oldest record
+ * @return false: index >= mlog_count()
+ ************************************************************************************/
+bool mlog_get(uint16_t index, mlog_record_t * record);
+
+/************************************************************************************
+ * @brief 16 bit hash of a UID as stored in the records.
+ ************************************************************************************/
+uint16_t mlog_uid_hash(const uint8_t uid[], uint8_t uid_length);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_MEASUREMENT_LOG_H_ */
@@ -0,0 +1,83 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Message.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Parser für die Textnachrichten des NFC-THMS-Sensor-Tags.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <THMS_Message.h>
+#include <THMS_Format.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Prototypes (Internal Functions) */
+/************************************************************************************
+ * Key -> thms_message_field_t
+ * @return: Field bit; 0 for unknown keys.
+ ************************************************************************************/
+static uint8_t key_to_field(const char key[], uint8_t length);
+/* >> END: Prototypes */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+bool thms_message_parse(const char text[], thms_message_t * message) {
+  memset(message, 0, sizeof(*message));
+  const char * p = text;
+  while (*p != '\0') {
+    const char * key = p;
+    while ((*p != ':') && (*p != ';') && (*p != '\0')) p++;
+    if ((*p != ':') || (p == key) || ((p - key) > 0xFF)) return false;   // Key without ':'
+    uint8_t field = key_to_field(key, p - key);
+    p++;
+    if (field == 0) {
+      while ((*p != ';') && (*p != '\0')) p++;   // Value of an unknown key (e.g. "FW:1.3")
+      if (message->unknown_keys < 0xFF) message->unknown_keys++;
+    } else {
+      bool is_do = (field == THMS_FIELD_DO);
+      uint32_t number;
+      if (fmt_parse_uint(p, is_do ? 16 : 10, is_do ? 0xFF : 0xFFFF, &number, &p) != FMT_OK) return false;
+      if ((*p != ';') && (*p != '\0')) return false;   // Other characters in the value
+      switch (field) {
+        case THMS_FIELD_DO: message->do_instruction = number; break;
+        case THMS_FIELD_NO: message->no = number; break;
+        case THMS_FIELD_SS: message->ss = number; break;
+        case THMS_FIELD_MS: message->ms = number; break;
+        default: message->rsqpb = number; break;
+      }
+      message->fields |= field;
+    }
+    if (*p == ';') p++;
+  }
+  return true;
+}
+
+bool thms_message_is_measurement(const thms_message_t * message) {
+  return (message->fields & THMS_FIELDS_MEASUREMENT) == THMS_FIELDS_MEASUREMENT;
+}
+
+bool thms_message_is_error(const thms_message_t * message) {
+  return (message->fields & THMS_FIELD_DO) && (message->do_instruction == THMS_DO_ERROR);
+}
+/* >> END: External Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal (Static) Functions */
+static uint8_t key_to_field(const char key[], uint8_t length) {
+  if (length == 2) {
+    if ((key[0] == 'D') && (key[1] == 'o')) return THMS_FIELD_DO;
+    if ((key[0] == 'N') && (key[1] == 'o')) return THMS_FIELD_NO;
+    if ((key[0] == 'S') && (key[1] == 'S')) return THMS_FIELD_SS;
+    if ((key[0] == 'M') && (key[1] == 'S')) return THMS_FIELD_MS;
+  } else if ((length == 5) && (strncmp(key, "RSQPB", 5) == 0)) {
+    return THMS_FIELD_RSQPB;
+  }
+  return 0;
+}
+/* >> END: Internal (Static) Functions */
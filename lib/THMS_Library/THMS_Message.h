@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Message.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Parser für die "Schlüssel:Wert;"-Textnachrichten des
+ *             NFC-THMS-Sensor-Tags (z.B. "Do:01;No:1;SS:123;MS:456;RSQPB:1203;").
+ *             Ein Durchlauf über den Text, ohne Kopie und ohne Heap; das
+ *             Ergebnis ist ein fester Datensatz.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_MESSAGE_H_
+#define _THMS_MESSAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+typedef enum {
+	THMS_FIELD_DO					= (0x1 << 0),	// "Do:" Instruction (hex)
+	THMS_FIELD_NO					= (0x1 << 1),	// "No:" Sequence number of the measurement
+	THMS_FIELD_SS					= (0x1 << 2),	// "SS:" Sensor signal
+	THMS_FIELD_MS					= (0x1 << 3),	// "MS:" Measurement signal
+	THMS_FIELD_RSQPB				= (0x1 << 4),	// "RSQPB:"
+	THMS_FIELDS_MEASUREMENT			= 0x1F			// All fields of a measurement
+}thms_message_field_t;
+
+#define THMS_DO_ERROR               0xFF   // "Do:FF": Tag did not understand the instruction
+
+/* Decoded message. Fields which are not set in "fields" are 0. */
+typedef struct thms_message_t {
+	uint8_t do_instruction;
+	uint16_t no;
+	uint16_t ss;
+	uint16_t ms;
+	uint16_t rsqpb;
+	uint8_t fields;					// thms_message_field_t bits of the keys found
+	uint8_t unknown_keys;			// Number of other keys (e.g. config answer "PL:100;ST:1;...")
+}thms_message_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Parses a tag message in one pass. Known keys need a number (Do hex, others
+ *        decimal <= 65535); values of unknown keys are skipped. The last pair may miss ';'.
+ *
+ * @param text: '\0'-terminated message
+ * @param message: Result
+ * @return true: Message has the "key:value;" format
+ * @return false: Syntax error or invalid number
+ ************************************************************************************/
+bool thms_message_parse(const char text[], thms_message_t * message);
+
+/************************************************************************************
+ * @brief true if all five measurement fields are present.
+ ************************************************************************************/
+bool thms_message_is_measurement(const thms_message_t * message);
+
+/************************************************************************************
+ * @brief true if the tag answered with "Do:FF" (error reply).
+ ************************************************************************************/
+bool thms_message_is_error(const thms_message_t * message);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_MESSAGE_H_ */
@@ -0,0 +1,89 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Profile.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Laufzeitmessung (nur mit -DTHMS_PROFILING).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <THMS_Profile.h>
+#include <DFRobot_PN532.h>
+
+#ifdef THMS_PROFILING
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static prof_counter_t counters_m[NUMBER_OF_PROF_POINTS];
+static unsigned long pn532_start_us_m[PN532_PROFILE_WRITE_COMMAND + 1];   // Start of the running driver access per point
+
+static const char prof_name_scan[] PROGMEM = "scan";
+static const char prof_name_read_ack[] PROGMEM = "readAck";
+static const char prof_name_write_command[] PROGMEM = "writeCommand";
+static const char prof_name_read_data[] PROGMEM = "read_data";
+static const char prof_name_set_instruction[] PROGMEM = "NT2S_set_instruction";
+static const char prof_name_fsm_idle[] PROGMEM = "FSM_IDLE";
+static const char prof_name_fsm_search_sensor[] PROGMEM = "FSM_SEARCH_SENSOR";
+static const char prof_name_fsm_write_instruction[] PROGMEM = "FSM_WRITE_INSTRUCTION";
+static const char prof_name_fsm_wait_for_response[] PROGMEM = "FSM_WAIT_FOR_RESPONSE";
+static const char prof_name_fsm_read_tag_data[] PROGMEM = "FSM_READ_TAG_DATA";
+static const char prof_name_fsm_error[] PROGMEM = "FSM_ERROR";
+static const char * const prof_names[NUMBER_OF_PROF_POINTS] PROGMEM = {
+  prof_name_scan, prof_name_read_ack, prof_name_write_command, prof_name_read_data, prof_name_set_instruction,
+  prof_name_fsm_idle, prof_name_fsm_search_sensor, prof_name_fsm_write_instruction,
+  prof_name_fsm_wait_for_response, prof_name_fsm_read_tag_data, prof_name_fsm_error
+};
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+prof_scope_t::~prof_scope_t() {
+  prof_record(point_, micros() - start_us_);
+}
+
+void prof_record(uint8_t point, unsigned long duration_us) {
+  if (point >= NUMBER_OF_PROF_POINTS) return;
+  prof_counter_t * counter = &counters_m[point];
+  if (counter->count < 0xFFFF) counter->count++;
+  counter->total_us += duration_us;
+  if (duration_us > counter->max_us) counter->max_us = duration_us;
+}
+
+void prof_retry(uint8_t point) {
+  if (point >= NUMBER_OF_PROF_POINTS) return;
+  if (counters_m[point].retries < 0xFFFF) counters_m[point].retries++;
+}
+
+void prof_reset(void) {
+  memset(counters_m, 0, sizeof(counters_m));
+}
+
+/* Hooks of the PN532 driver (-DPN532_PROFILING): PN532_PROFILE_* has the order of PROF_SCAN.. */
+void pn532ProfileBegin(uint8_t point) {
+  pn532_start_us_m[point] = micros();
+}
+
+void pn532ProfileEnd(uint8_t point) {
+  prof_record(PROF_SCAN + point, micros() - pn532_start_us_m[point]);
+}
+
+void pn532ProfileRetry(uint8_t point) {
+  prof_retry(PROF_SCAN + point);
+}
+
+const prof_counter_t * prof_get(uint8_t point) {
+  return (point < NUMBER_OF_PROF_POINTS) ? &counters_m[point] : NULL;
+}
+
+const __FlashStringHelper * prof_name(uint8_t point) {
+  if (point >= NUMBER_OF_PROF_POINTS) point = PROF_FSM_ERROR;
+  return (const __FlashStringHelper *)pgm_read_ptr(&prof_names[point]);
+}
+/* >> END: External Functions */
+
+#endif /* THMS_PROFILING */
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Profile.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Laufzeitmessung der zeitkritischen Funktionen (PN532-Zugriffe,
+ *             Tag-Zugriffe, FSM-Zustände). Je Messpunkt werden Anzahl, Summe
+ *             und Maximum der Dauer in µs sowie Wiederholungen gezählt.
+ *             Nur aktiv mit -DTHMS_PROFILING (siehe platformio.ini,
+ *             env:nanoatmega328_profile); sonst sind alle Makros leer und es
+ *             wird weder Code noch RAM belegt.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_PROFILE_H_
+#define _THMS_PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+typedef enum {
+	PROF_SCAN,						// PN532_PROFILE_SCAN hook (same order as ePN532ProfilePoint_t): scan() / scanTargets()
+	PROF_READ_ACK,					// PN532_PROFILE_READ_ACK hook: PN532_I2C/PN532_HSU::readAck() (retry: frame read again after NACK)
+	PROF_WRITE_COMMAND,				// PN532_PROFILE_WRITE_COMMAND hook: PN532_I2C/PN532_HSU::writeCommand() / writeFrame_P()
+	PROF_READ_DATA,					// read_data() in NFC_THMS_to_Serial (retry: failed READ/FAST_READ)
+	PROF_SET_INSTRUCTION,			// NT2S_set_instruction() (retry: failed page write)
+	PROF_FSM_IDLE,					// One fsm_task() step per state
+	PROF_FSM_SEARCH_SENSOR,
+	PROF_FSM_WRITE_INSTRUCTION,
+	PROF_FSM_WAIT_FOR_RESPONSE,
+	PROF_FSM_READ_TAG_DATA,
+	PROF_FSM_ERROR,					// FSM_ERROR and other states
+	NUMBER_OF_PROF_POINTS
+}prof_point_t;
+
+typedef struct prof_counter_t {
+	uint16_t count;					// Saturates at 0xFFFF
+	uint16_t retries;				// Saturates at 0xFFFF
+	uint32_t total_us;
+	uint32_t max_us;
+}prof_counter_t;
+
+#ifdef THMS_PROFILING
+#include "Arduino.h"
+
+/* Measures the time until the end of the enclosing block (all return paths) */
+class prof_scope_t {
+public:
+  prof_scope_t(uint8_t point) : point_(point), start_us_(micros()) {}
+  ~prof_scope_t();
+private:
+  uint8_t point_;
+  unsigned long start_us_;
+};
+
+#define PROF_SCOPE(point)     prof_scope_t prof_scope_guard_(point)
+#define PROF_RETRY(point)     prof_retry(point)
+#else
+#define PROF_SCOPE(point)
+#define PROF_RETRY(point)
+#endif
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+#ifdef THMS_PROFILING
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Adds one call with the given duration.
+ ************************************************************************************/
+void prof_record(uint8_t point, unsigned long duration_us);
+
+/************************************************************************************
+ * @brief Counts one retry.
+ ************************************************************************************/
+void prof_retry(uint8_t point);
+
+/************************************************************************************
+ * @brief Sets all counters to 0.
+ ************************************************************************************/
+void prof_reset(void);
+
+/************************************************************************************
+ * @brief Counter of a profiling point (NULL if point >= NUMBER_OF_PROF_POINTS).
+ ************************************************************************************/
+const prof_counter_t * prof_get(uint8_t point);
+
+/************************************************************************************
+ * @brief Name of a profiling point (PROGMEM string, e.g. "readAck").
+ ************************************************************************************/
+const __FlashStringHelper * prof_name(uint8_t point);
+
+/* >> END: External Functions */
+#endif /* THMS_PROFILING */
+
+#endif /* _THMS_PROFILE_H_ */
@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Retry.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Wiederholungsstrategie mit Fehlerklassen und adaptivem Backoff.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <THMS_Retry.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define RESPONSE_TIMEOUT_FACTOR     8      // Response timeout = factor * learned latency
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static uint16_t error_counts_m[DFRobot_PN532::STATUS_COUNT];
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+void retry_begin(retry_t * retry, retry_policy_t * policy) {
+  retry->policy = policy;
+  retry->tries = 0;
+  retry->backoff_ms = 0;
+  retry->no_response = false;
+  retry->attempt_start_ms = millis();
+}
+
+bool retry_failed(retry_t * retry, retry_status_t status) {
+  const retry_policy_t * policy = retry->policy;
+  if ((status < DFRobot_PN532::STATUS_COUNT) && (error_counts_m[status] < 0xFFFF)) error_counts_m[status]++;
+  if (status == DFRobot_PN532::STATUS_NO_RESPONSE) retry->no_response = true;
+  retry->tries++;
+  if (!retry_is_transient(status, policy->retry_no_target) || (retry->tries >= policy->max_tries)) return false;
+  // Exponential backoff: latency, 2*latency, 4*latency, ... within [min, max]
+  uint32_t backoff = (uint32_t)policy->latency_ms << (retry->tries - 1);
+  if ((retry->tries > 16) || (backoff > policy->max_backoff_ms)) backoff = policy->max_backoff_ms;
+  if (backoff < policy->min_backoff_ms) backoff = policy->min_backoff_ms;
+  retry->backoff_ms = backoff;
+  retry->attempt_start_ms = millis() + backoff;
+  return true;
+}
+
+void retry_succeeded(retry_t * retry) {
+  retry_policy_t * policy = retry->policy;
+  long duration = (long)(millis() - retry->attempt_start_ms);
+  if (duration < 0) duration = 0;
+  if (duration > 0xFFFF) duration = 0xFFFF;
+  policy->latency_ms = (uint16_t)((3UL*policy->latency_ms + duration + 3) / 4);   // Moving average, rounded up
+  retry->attempt_start_ms = millis();   // Next step of the same operation
+}
+
+void retry_resume(retry_t * retry) {
+  retry->attempt_start_ms = millis();
+}
+
+uint16_t retry_response_timeout_ms(const retry_t * retry) {
+  if (retry->no_response) return PN532_RESPONSE_TIMEOUT_MS;
+  uint32_t timeout = (uint32_t)RESPONSE_TIMEOUT_FACTOR*retry->policy->latency_ms;
+  if (timeout < RETRY_MIN_RESPONSE_TIMEOUT_MS) timeout = RETRY_MIN_RESPONSE_TIMEOUT_MS;
+  if (timeout > PN532_RESPONSE_TIMEOUT_MS) timeout = PN532_RESPONSE_TIMEOUT_MS;
+  return timeout;
+}
+
+bool retry_is_transient(retry_status_t status, bool retry_no_target) {
+  switch (status) {
+    case DFRobot_PN532::STATUS_NO_RESPONSE:    // PN532 busy
+    case DFRobot_PN532::STATUS_FRAME_ERROR:    // Disturbed I2C/UART frame
+    case DFRobot_PN532::STATUS_RF_TIMEOUT:     // Tag did not answer once; next attempt selects it again
+    case DFRobot_PN532::STATUS_RF_ERROR:       // CRC/parity/framing on the RF side
+      return true;
+    case DFRobot_PN532::STATUS_NO_TARGET:      // Tag removed: fail fast (except while searching)
+      return retry_no_target;
+    default:                                   // Command not acceptable: same result again
+      return false;
+  }
+}
+
+uint16_t retry_error_count(retry_status_t status) {
+  return (status < DFRobot_PN532::STATUS_COUNT) ? error_counts_m[status] : 0;
+}
+
+void retry_reset_counters(void) {
+  memset(error_counts_m, 0, sizeof(error_counts_m));
+}
+/* >> END: External Functions */
@@ -0,0 +1,107 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Retry.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Gemeinsame Wiederholungsstrategie für Tag-Zugriffe und Sensorsuche.
+ *             Fehler werden anhand des PN532-Status klassifiziert: nur
+ *             vorübergehende Fehler (Übertragungs-/RF-Fehler) werden wiederholt,
+ *             ein entfernter Tag bricht sofort ab. Die Wartezeit wächst
+ *             exponentiell und startet bei der zuletzt gemessenen Dauer eines
+ *             erfolgreichen Versuchs. Fehler werden je Status gezählt.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_RETRY_H_
+#define _THMS_RETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <DFRobot_PN532.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define RETRY_MIN_RESPONSE_TIMEOUT_MS   100    // Lower limit of the adaptive PN532 response timeout
+
+typedef DFRobot_PN532::eStatus_t retry_status_t;
+
+/* Policy of one kind of operation. latency_ms is learned at runtime. */
+typedef struct retry_policy_t {
+	uint8_t max_tries;				// Attempts incl. the first one
+	uint16_t min_backoff_ms;
+	uint16_t max_backoff_ms;
+	bool retry_no_target;			// true: "no tag in the field" is worth a retry (sensor search)
+	uint16_t latency_ms;			// Smoothed duration of successful attempts
+}retry_policy_t;
+
+#define RETRY_POLICY(max_tries, min_backoff_ms, max_backoff_ms, retry_no_target) \
+	{(max_tries), (min_backoff_ms), (max_backoff_ms), (retry_no_target), (min_backoff_ms)}
+
+/* One operation with its attempts */
+typedef struct retry_t {
+	retry_policy_t * policy;
+	uint8_t tries;					// Failed attempts so far
+	uint16_t backoff_ms;			// Wait before the next attempt (valid after retry_failed() == true)
+	bool no_response;				// PN532 did not answer in this operation -> full response timeout
+	unsigned long attempt_start_ms;
+}retry_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Starts an operation (first attempt follows immediately).
+ ************************************************************************************/
+void retry_begin(retry_t * retry, retry_policy_t * policy);
+
+/************************************************************************************
+ * @brief Attempt failed: counts the error and decides whether to try again.
+ *
+ * @param status: DFRobot_PN532::lastStatus() of the failed attempt
+ * @return true: Try again after retry->backoff_ms
+ * @return false: Permanent error (e.g. tag removed) or no tries left
+ ************************************************************************************/
+bool retry_failed(retry_t * retry, retry_status_t status);
+
+/************************************************************************************
+ * @brief Attempt succeeded: updates the latency of the policy. An operation may
+ *        consist of several steps (e.g. read bursts), each one is measured alone.
+ ************************************************************************************/
+void retry_succeeded(retry_t * retry);
+
+/************************************************************************************
+ * @brief Next attempt starts now. For operations that are continued by a later call
+ *        (the backoff was waited outside), so the wait does not count as latency.
+ ************************************************************************************/
+void retry_resume(retry_t * retry);
+
+/************************************************************************************
+ * @brief Time to wait for the PN532 in the next attempt: a multiple of the learned
+ *        latency, the full PN532_RESPONSE_TIMEOUT_MS after a missing response.
+ ************************************************************************************/
+uint16_t retry_response_timeout_ms(const retry_t * retry);
+
+/************************************************************************************
+ * @brief true if an error of this kind may go away by trying again.
+ ************************************************************************************/
+bool retry_is_transient(retry_status_t status, bool retry_no_target);
+
+/************************************************************************************
+ * @brief Number of failed attempts with this status (since retry_reset_counters).
+ ************************************************************************************/
+uint16_t retry_error_count(retry_status_t status);
+
+/************************************************************************************
+ * @brief Sets all error counters to 0.
+ ************************************************************************************/
+void retry_reset_counters(void);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_RETRY_H_ */
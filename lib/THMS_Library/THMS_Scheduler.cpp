@@ -0,0 +1,52 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Scheduler.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Kooperativer, millis()-basierter Scheduler mit Deadline-Timern.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <Arduino.h>
+#include <THMS_Scheduler.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+void sched_run(sched_task_t tasks[], uint8_t number_of_tasks) {
+  for (uint8_t i = 0; i < number_of_tasks; i++) {
+    sched_task_t * task = &tasks[i];
+    if (!task->enabled) continue;
+    unsigned long now_ms = millis();
+    if (task->triggered || ((now_ms - task->last_run_ms) >= task->interval_ms)) {
+      task->triggered = false;
+      task->last_run_ms = now_ms;
+      task->function();
+    }
+  }
+}
+
+void sched_task_trigger(sched_task_t * task) {
+  task->triggered = true;
+}
+
+void sched_deadline_start(sched_deadline_t * deadline, unsigned long duration_ms) {
+  deadline->start_ms = millis();
+  deadline->duration_ms = duration_ms;
+  deadline->running = true;
+}
+
+void sched_deadline_stop(sched_deadline_t * deadline) {
+  deadline->running = false;
+}
+
+bool sched_deadline_expired(const sched_deadline_t * deadline) {
+  return deadline->running && ((millis() - deadline->start_ms) >= deadline->duration_ms);
+}
+
+bool sched_deadline_running(const sched_deadline_t * deadline) {
+  return deadline->running;
+}
+/* >> END: External Functions */
@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Scheduler.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Kooperativer, millis()-basierter Scheduler mit Deadline-Timern.
+ *             Tasks laufen zyklisch (Intervall) oder sofort nach einem Trigger;
+ *             Wartezeiten werden über Deadlines statt delay() abgebildet.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_SCHEDULER_H_
+#define _THMS_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+typedef void (*sched_task_function_t)(void);
+
+typedef struct sched_task_t {
+	sched_task_function_t function;
+	unsigned long interval_ms;		// 0: Task läuft in jedem Durchlauf
+	unsigned long last_run_ms;
+	bool triggered;					// Im nächsten Durchlauf unabhängig vom Intervall ausführen
+	bool enabled;
+}sched_task_t;
+
+#define SCHED_TASK(function, interval_ms) {(function), (interval_ms), 0, true, true}
+
+typedef struct sched_deadline_t {
+	unsigned long start_ms;
+	unsigned long duration_ms;
+	bool running;
+}sched_deadline_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Runs every task that is due (interval elapsed or triggered) once. Never blocks.
+ *
+ * @param tasks: Task table
+ * @param number_of_tasks: Number of entries in tasks
+ ************************************************************************************/
+void sched_run(sched_task_t tasks[], uint8_t number_of_tasks);
+
+/************************************************************************************
+ * @brief Lets a task run in the next sched_run() call regardless of its interval.
+ ************************************************************************************/
+void sched_task_trigger(sched_task_t * task);
+
+/************************************************************************************
+ * @brief Starts (or restarts) a deadline timer.
+ *
+ * @param deadline: Timer
+ * @param duration_ms: Time until the deadline expires
+ ************************************************************************************/
+void sched_deadline_start(sched_deadline_t * deadline, unsigned long duration_ms);
+
+/************************************************************************************
+ * @brief Stops a deadline timer.
+ ************************************************************************************/
+void sched_deadline_stop(sched_deadline_t * deadline);
+
+/************************************************************************************
+ * @brief Checks a deadline timer (millis() overflow safe).
+ *
+ * @return true: Timer is running and the deadline has passed
+ * @return false: Timer stopped or still running
+ ************************************************************************************/
+bool sched_deadline_expired(const sched_deadline_t * deadline);
+
+/************************************************************************************
+ * @return true: Timer started and not stopped yet (expired or not)
+ ************************************************************************************/
+bool sched_deadline_running(const sched_deadline_t * deadline);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_SCHEDULER_H_ */
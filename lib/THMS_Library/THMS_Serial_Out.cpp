@@ -0,0 +1,60 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Serial_Out.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ausgabe über den TX-Puffer der seriellen Schnittstelle mit
+ *             Füllstandsmessung.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <THMS_Serial_Out.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static uint16_t high_water_m = 0;
+static uint16_t stalls_m = 0;
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Variables */
+sout_writer_t sout;
+/* >> END: External Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions */
+size_t sout_writer_t::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t sout_writer_t::write(const uint8_t * buffer, size_t size) {
+  if (serial_ == NULL) return 0;
+  int free_bytes = serial_->availableForWrite();
+  if ((int)size > free_bytes) {                     // Only now the UART is waited for
+    if (stalls_m < 0xFFFF) stalls_m++;
+    high_water_m = SOUT_TX_BUFFER_SIZE;
+  }
+  size_t written = serial_->write(buffer, size);
+  int waiting = SOUT_TX_BUFFER_SIZE - serial_->availableForWrite();
+  if (waiting > (int)high_water_m) high_water_m = waiting;
+  return written;
+}
+
+uint16_t sout_high_water(void) {
+  return high_water_m;
+}
+
+uint16_t sout_stalls(void) {
+  return stalls_m;
+}
+
+void sout_reset_counters(void) {
+  high_water_m = 0;
+  stalls_m = 0;
+}
+/* >> END: External Functions */
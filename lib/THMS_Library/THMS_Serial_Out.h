@@ -0,0 +1,74 @@
+/**************************************************************************/
+/*!
+ *   @file: THMS_Serial_Out.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ausgabestufe für alle Textzeilen und Binär-Frames. Die Bytes
+ *             landen im TX-Puffer der seriellen Schnittstelle und werden vom
+ *             UART-Interrupt im Hintergrund gesendet; gewartet wird nur, wenn
+ *             der Puffer voll ist (kein Serial.flush() mehr je Durchlauf).
+ *             Der höchste Füllstand und die Anzahl voller Puffer werden
+ *             gezählt (Befehl "E"). Puffergröße: -DSERIAL_TX_BUFFER_SIZE
+ *             (siehe platformio.ini).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _THMS_SERIAL_OUT_H_
+#define _THMS_SERIAL_OUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Arduino.h"
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE       64     // Default of the AVR core
+#endif
+#define SOUT_TX_BUFFER_SIZE         (SERIAL_TX_BUFFER_SIZE - 1)   // Usable bytes of the ring buffer
+
+/* Print target of the bridge output (sout.print(...), sout.write(frame, length)) */
+class sout_writer_t : public Print {
+public:
+  void begin(HardwareSerial * serial) { serial_ = serial; }
+  size_t write(uint8_t c);
+  size_t write(const uint8_t * buffer, size_t size);
+  using Print::write;
+private:
+  HardwareSerial * serial_ = NULL;
+};
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Variables */
+extern sout_writer_t sout;
+/* >> END: External Variables */
+
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+
+/************************************************************************************
+ * @brief Highest number of bytes waiting in the TX buffer (since sout_reset_counters).
+ ************************************************************************************/
+uint16_t sout_high_water(void);
+
+/************************************************************************************
+ * @brief Number of writes that had to wait for free space in the TX buffer.
+ ************************************************************************************/
+uint16_t sout_stalls(void);
+
+/************************************************************************************
+ * @brief Sets high-water mark and stall counter to 0.
+ ************************************************************************************/
+void sout_reset_counters(void);
+
+/* >> END: External Functions */
+
+#endif /* _THMS_SERIAL_OUT_H_ */
@@ -0,0 +1,191 @@
+/**************************************************************************/
+/*!
+ *   @file: Arduino.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Minimaler Ersatz des Arduino-AVR-Cores für env:native. Enthält nur
+ *             die von DFRobot_PN532, der THMS-Bibliothek und der Bridge-Firmware
+ *             genutzte API. Zeit ist virtuell (siehe SimHooks.h).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _SIM_ARDUINO_H_
+#define _SIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <string>
+
+#include "SimHooks.h"
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define HIGH            0x1
+#define LOW             0x0
+#define INPUT           0x0
+#define OUTPUT          0x1
+#define INPUT_PULLUP    0x2
+#define LED_BUILTIN     13
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+/* Program memory is ordinary memory on the host */
+#define PROGMEM
+#define PGM_P                   const char *
+#define PSTR(s)                 (s)
+#define pgm_read_byte(addr)     (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr)      (*(void * const *)(addr))
+#define memcpy_P                memcpy
+#define memcmp_P                memcmp
+#define strlen_P                strlen
+#define strcpy_P                strcpy
+#define strncpy_P               strncpy
+#define strcmp_P                strcmp
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+#define noInterrupts()
+#define interrupts()
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Time & GPIO */
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+/* >> END: Time & GPIO */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: String */
+class String {
+public:
+  String(const char * cstr = "") : s_(cstr ? cstr : "") {}
+  String(const __FlashStringHelper * fstr) : s_(reinterpret_cast<const char *>(fstr)) {}
+  explicit String(char c) : s_(1, c) {}
+  String(unsigned char value, unsigned char base = 10) { fromUnsigned(value, base); }
+  String(int value, unsigned char base = 10);
+  String(unsigned int value, unsigned char base = 10) { fromUnsigned(value, base); }
+  String(long value, unsigned char base = 10);
+  String(unsigned long value, unsigned char base = 10) { fromUnsigned(value, base); }
+
+  String & operator += (const String & rhs) { s_ += rhs.s_; return *this; }
+  String & operator += (const char * rhs) { s_ += rhs; return *this; }
+  String & operator += (char c) { s_ += c; return *this; }
+  bool operator == (const String & rhs) const { return s_ == rhs.s_; }
+  bool operator == (const char * rhs) const { return s_ == rhs; }
+  bool operator != (const String & rhs) const { return s_ != rhs.s_; }
+  bool operator != (const char * rhs) const { return s_ != rhs; }
+  unsigned int length(void) const { return (unsigned int)s_.length(); }
+  const char * c_str(void) const { return s_.c_str(); }
+  char operator [] (unsigned int index) const { return s_[index]; }
+
+private:
+  void fromUnsigned(unsigned long value, unsigned char base);
+  std::string s_;
+};
+/* >> END: String */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Print / Stream / HardwareSerial */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t * buffer, size_t size);
+  size_t write(const char * str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+  virtual int availableForWrite(void) { return 0; }
+  virtual void flush(void) {}
+
+  size_t print(const __FlashStringHelper * ifsh) { return write(reinterpret_cast<const char *>(ifsh)); }
+  size_t print(const String & s) { return write(s.c_str()); }
+  size_t print(const char * str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int base = DEC) { return printNumber(n, base); }
+  size_t print(int n, int base = DEC) { return printSigned(n, base); }
+  size_t print(unsigned int n, int base = DEC) { return printNumber(n, base); }
+  size_t print(long n, int base = DEC) { return printSigned(n, base); }
+  size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+  size_t print(double n, int digits = 2);
+
+  size_t println(void) { return write("\r\n"); }
+  template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+private:
+  size_t printNumber(unsigned long n, int base);
+  size_t printSigned(long n, int base);
+};
+
+class Stream : public Print {
+public:
+  virtual int available(void) = 0;
+  virtual int read(void) = 0;
+  virtual int peek(void) = 0;
+  void setTimeout(unsigned long timeout) { timeout_ = timeout; }
+  size_t readBytesUntil(char terminator, char * buffer, size_t length);
+  size_t readBytes(char * buffer, size_t length);
+
+protected:
+  unsigned long timeout_ = 1000;
+  int timedRead(void);
+};
+
+class HardwareSerial : public Stream {
+public:
+  /* Console (Serial) when peer == NULL, otherwise a UART wired to a simulated device */
+  explicit HardwareSerial(SimUartDevice * peer = NULL) : peer_(peer) {}
+  void begin(unsigned long baud);
+  void end(void) {}
+  int available(void);
+  int read(void);
+  int peek(void);
+  size_t write(uint8_t c);
+  using Print::write;
+  int availableForWrite(void) { return 63; }
+  void flush(void) {}
+  operator bool() { return true; }
+
+  void attach(SimUartDevice * peer) { peer_ = peer; }
+  void deliver(uint8_t c);              // Byte from the peer/host towards the MCU
+  unsigned long baud(void) const { return baud_; }
+
+private:
+  SimUartDevice * peer_;
+  unsigned long baud_ = 115200;
+  std::string rx_;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;          // Free UART for a PN532 wired in HSU mode
+/* >> END: Print / Stream / HardwareSerial */
+
+#endif /* _SIM_ARDUINO_H_ */
@@ -0,0 +1,245 @@
+/**************************************************************************/
+/*!
+ *   @file: ArduinoShim.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Implementierung des Arduino-Ersatzes für env:native (Uhr, GPIO,
+ *             String, Print/Stream, Serial, Wire).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <deque>
+#include <map>
+#include <utility>
+
+#include "Arduino.h"
+#include "Wire.h"
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Local Variables */
+#define SIM_US_PER_CLOCK_READ   4   // Busy-wait loops on millis()/micros() must make progress
+
+static unsigned long long now_us_m = 0;
+static sim_stats_t stats_m;
+static std::map<uint8_t, SimI2CDevice *> i2c_devices_m;
+static std::map<uint8_t, SimPinSource *> pin_sources_m;
+static std::map<uint8_t, uint8_t> pin_levels_m;
+static std::string * serial_capture_m = NULL;   // Output of the ports without peer (NULL: stdout)
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+TwoWire Wire;
+/* >> END: Local Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Simulation hooks */
+unsigned long long sim_now_us(void) { return now_us_m; }
+void sim_advance_us(unsigned long long us) { now_us_m += us; }
+sim_stats_t * sim_stats(void) { return &stats_m; }
+void sim_reset_stats(void) { memset(&stats_m, 0, sizeof(stats_m)); }
+void sim_attach_i2c(uint8_t address, SimI2CDevice * device) { i2c_devices_m[address] = device; }
+void sim_attach_pin(uint8_t pin, SimPinSource * source) { pin_sources_m[pin] = source; }
+
+void sim_serial_inject(const char * text) {
+  while (*text) Serial.deliver((uint8_t)*text++);
+}
+
+void sim_serial_capture(std::string * output) { serial_capture_m = output; }
+/* >> END: Simulation hooks */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Time & GPIO */
+unsigned long millis(void) { now_us_m += SIM_US_PER_CLOCK_READ; return (unsigned long)(now_us_m/1000ULL); }
+unsigned long micros(void) { now_us_m += SIM_US_PER_CLOCK_READ; return (unsigned long)now_us_m; }
+void delay(unsigned long ms) { now_us_m += 1000ULL*ms; stats_m.sleep_us += 1000ULL*ms; }
+void delayMicroseconds(unsigned int us) { now_us_m += us; stats_m.sleep_us += us; }
+void yield(void) {}
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t val) { pin_levels_m[pin] = val; }
+
+int digitalRead(uint8_t pin) {
+  now_us_m += SIM_US_PER_CLOCK_READ;
+  std::map<uint8_t, SimPinSource *>::iterator it = pin_sources_m.find(pin);
+  if (it != pin_sources_m.end()) return it->second->pinLevel();
+  return pin_levels_m.count(pin) ? pin_levels_m[pin] : HIGH;
+}
+/* >> END: Time & GPIO */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: String */
+static std::string number_to_string(unsigned long value, unsigned char base) {
+  static const char digits[] = "0123456789abcdef";
+  if (base < 2 || base > 16) base = 10;
+  std::string s;
+  do { s.insert(s.begin(), digits[value % base]); value /= base; } while (value);
+  return s;
+}
+
+void String::fromUnsigned(unsigned long value, unsigned char base) { s_ = number_to_string(value, base); }
+
+String::String(int value, unsigned char base) {
+  if (value < 0 && base == 10) s_ = "-" + number_to_string((unsigned long)(-(long)value), 10);
+  else s_ = number_to_string((unsigned int)value, base);
+}
+
+String::String(long value, unsigned char base) {
+  if (value < 0 && base == 10) s_ = "-" + number_to_string((unsigned long)(-value), 10);
+  else s_ = number_to_string((unsigned long)value, base);
+}
+/* >> END: String */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Print / Stream */
+size_t Print::write(const uint8_t * buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printNumber(unsigned long n, int base) {
+  std::string s = number_to_string(n, (unsigned char)base);
+  for (size_t i = 0; i < s.size(); i++) if (s[i] >= 'a') s[i] -= 0x20;  // Arduino prints hex upper case
+  return write((const uint8_t *)s.c_str(), s.size());
+}
+
+size_t Print::printSigned(long n, int base) {
+  if ((base == DEC) && (n < 0)) return write('-') + printNumber((unsigned long)(-n), base);
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[40];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+int Stream::timedRead(void) {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - start < timeout_);
+  return -1;
+}
+
+size_t Stream::readBytesUntil(char terminator, char * buffer, size_t length) {
+  size_t index = 0;
+  while (index < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) break;
+    buffer[index++] = (char)c;
+  }
+  return index;
+}
+
+size_t Stream::readBytes(char * buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+/* >> END: Print / Stream */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: HardwareSerial */
+void HardwareSerial::begin(unsigned long baud) {
+  baud_ = baud;
+  if (peer_) peer_->uartSetBaud(baud);
+}
+
+int HardwareSerial::available(void) {
+  now_us_m += SIM_US_PER_CLOCK_READ;
+  if (peer_) peer_->uartPoll();
+  return (int)rx_.size();
+}
+
+int HardwareSerial::read(void) {
+  if (peer_) peer_->uartPoll();
+  if (rx_.empty()) return -1;
+  uint8_t c = (uint8_t)rx_[0];
+  rx_.erase(0, 1);
+  if (peer_) stats_m.uart_bytes_rx++;
+  return c;
+}
+
+int HardwareSerial::peek(void) { return rx_.empty() ? -1 : (uint8_t)rx_[0]; }
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (peer_) {
+    unsigned long long us = 10ULL*1000000ULL/baud_;  // Start + 8 data + stop bit
+    now_us_m += us;
+    stats_m.io_us += us;
+    stats_m.uart_bytes_tx++;
+    peer_->uartReceive(c);
+  } else if (serial_capture_m != NULL) {
+    serial_capture_m->push_back((char)c);
+  } else {
+    fputc(c, stdout);
+  }
+  return 1;
+}
+
+void HardwareSerial::deliver(uint8_t c) { rx_.push_back((char)c); }
+/* >> END: HardwareSerial */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: TwoWire */
+static void charge_i2c(size_t bytes) {
+  unsigned long long us = SIM_I2C_US_OVERHEAD + (unsigned long long)bytes*SIM_I2C_US_PER_BYTE;
+  now_us_m += us;
+  stats_m.io_us += us;
+  stats_m.i2c_transactions++;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  tx_address_ = address;
+  tx_length_ = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (tx_length_ >= BUFFER_LENGTH) return 0;
+  tx_buffer_[tx_length_++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t * data, size_t quantity) {
+  size_t n = 0;
+  while (quantity--) n += write(*data++);
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  charge_i2c(tx_length_);
+  stats_m.i2c_bytes_tx += tx_length_ + 1;
+  std::map<uint8_t, SimI2CDevice *>::iterator it = i2c_devices_m.find(tx_address_);
+  if (it == i2c_devices_m.end()) return 2;   // Address NACK
+  it->second->i2cWrite(tx_buffer_, tx_length_);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+  if (quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+  rx_index_ = 0;
+  rx_length_ = 0;
+  std::map<uint8_t, SimI2CDevice *>::iterator it = i2c_devices_m.find(address);
+  charge_i2c(quantity);
+  stats_m.i2c_bytes_rx += quantity + 1;
+  if (it == i2c_devices_m.end()) return 0;
+  rx_length_ = (uint8_t)it->second->i2cRead(rx_buffer_, quantity);
+  return rx_length_;
+}
+/* >> END: TwoWire */
@@ -0,0 +1,37 @@
+/**************************************************************************/
+/*!
+ *   @file: EEPROM.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ersatz der Arduino-EEPROM-Bibliothek für env:native
+ *             (1 KB wie ATmega328, gelöscht = 0xFF, flüchtig).
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _SIM_EEPROM_H_
+#define _SIM_EEPROM_H_
+
+#include "Arduino.h"
+
+#ifndef E2END
+#define E2END 0x3FF
+#endif
+
+class EEPROMClass {
+public:
+  EEPROMClass() { memset(data_, 0xFF, sizeof(data_)); }
+  uint8_t read(int address) { return data_[address & E2END]; }
+  void write(int address, uint8_t value) { data_[address & E2END] = value; }
+  void update(int address, uint8_t value) { if (read(address) != value) write(address, value); }
+  uint16_t length(void) { return E2END + 1; }
+
+private:
+  uint8_t data_[E2END + 1];
+};
+
+static EEPROMClass EEPROM;
+
+#endif /* _SIM_EEPROM_H_ */
@@ -0,0 +1,82 @@
+/**************************************************************************/
+/*!
+ *   @file: SimHooks.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Schnittstelle zwischen dem Arduino-Ersatz für den Host und den
+ *             simulierten Peripherien (PN532 an I2C/HSU, IRQ-Pin). Die Zeit ist
+ *             virtuell: delay() und Bus-Transfers stellen die simulierte Uhr vor,
+ *             statt zu warten. Ein Messzyklus läuft so in Mikrosekunden Host-Zeit,
+ *             seine Dauer auf dem Zielsystem wird trotzdem erfasst.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _SIM_HOOKS_H_
+#define _SIM_HOOKS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define SIM_I2C_CLOCK_HZ        100000UL  // Standard mode I2C, as used by Wire on the Nano
+#define SIM_I2C_US_PER_BYTE     (9UL*1000000UL/SIM_I2C_CLOCK_HZ)  // 8 data bits + ACK
+#define SIM_I2C_US_OVERHEAD     (2UL*SIM_I2C_US_PER_BYTE)  // START + address byte + STOP
+
+/* Device on the simulated I2C bus */
+class SimI2CDevice {
+public:
+  virtual ~SimI2CDevice() {}
+  virtual void i2cWrite(const uint8_t *data, size_t length) = 0;      // One complete master write transaction
+  virtual size_t i2cRead(uint8_t *buffer, size_t length) = 0;         // One complete master read transaction
+};
+
+/* Device on the far end of a simulated UART */
+class SimUartDevice {
+public:
+  virtual ~SimUartDevice() {}
+  virtual void uartReceive(uint8_t data) = 0;                          // Byte sent by the MCU
+  virtual void uartSetBaud(unsigned long baud) { (void)baud; }
+  virtual void uartPoll(void) {}                                       // Deliver bytes that are due by now
+};
+
+/* Input pin driven by a simulated device (e.g. PN532 IRQ) */
+class SimPinSource {
+public:
+  virtual ~SimPinSource() {}
+  virtual int pinLevel(void) = 0;
+};
+
+/* Bus traffic and time accounting */
+typedef struct {
+  unsigned long i2c_bytes_tx;       // Bytes written by the MCU on I2C (incl. address)
+  unsigned long i2c_bytes_rx;       // Bytes read by the MCU on I2C (incl. address)
+  unsigned long i2c_transactions;   // Number of START..STOP sequences
+  unsigned long uart_bytes_tx;      // Bytes sent by the MCU to the PN532 via HSU
+  unsigned long uart_bytes_rx;      // Bytes received by the MCU from the PN532 via HSU
+  unsigned long pn532_commands;     // Host frames accepted by the PN532
+  unsigned long rf_transactions;    // Commands that caused RF traffic (InList/InDataExchange/InCommunicateThru)
+  unsigned long long sleep_us;      // Time spent in delay()/delayMicroseconds()
+  unsigned long long io_us;         // Time spent on the wire (I2C/UART)
+}sim_stats_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: External Functions (Deklarationen/Prototypen)*/
+unsigned long long sim_now_us(void);                  // Virtual time since start
+void sim_advance_us(unsigned long long us);           // Advance virtual time (no accounting)
+sim_stats_t * sim_stats(void);                        // Global counters
+void sim_reset_stats(void);
+
+void sim_attach_i2c(uint8_t address, SimI2CDevice * device);
+void sim_attach_pin(uint8_t pin, SimPinSource * source);
+void sim_serial_inject(const char * text);             // Queue host->bridge bytes on Serial
+void sim_serial_capture(std::string * output);         // Bridge->host bytes are appended to output instead of stdout (NULL: stdout)
+/* >> END: External Functions */
+
+#endif /* _SIM_HOOKS_H_ */
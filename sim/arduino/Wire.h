@@ -0,0 +1,50 @@
+/**************************************************************************/
+/*!
+ *   @file: Wire.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Ersatz der Arduino-Klasse TwoWire für env:native. Transaktionen gehen
+ *             an das unter der Slave-Adresse registrierte SimI2CDevice, die
+ *             Übertragungszeit wird der virtuellen Uhr angerechnet.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _SIM_WIRE_H_
+#define _SIM_WIRE_H_
+
+#include "Arduino.h"
+
+#ifndef BUFFER_LENGTH
+#define BUFFER_LENGTH 32    // Same receive/transmit buffer as the AVR Wire library (-DBUFFER_LENGTH=64: e.g. ESP32)
+#endif
+
+class TwoWire : public Stream {
+public:
+  void begin(void) {}
+  void setClock(uint32_t clock) { (void)clock; }
+  void beginTransmission(uint8_t address);
+  void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity);
+  uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+  size_t write(uint8_t data);
+  size_t write(const uint8_t * data, size_t quantity);
+  int available(void) { return (int)(rx_length_ - rx_index_); }
+  int read(void) { return (rx_index_ < rx_length_) ? rx_buffer_[rx_index_++] : -1; }
+  int peek(void) { return (rx_index_ < rx_length_) ? rx_buffer_[rx_index_] : -1; }
+
+private:
+  uint8_t tx_address_ = 0;
+  uint8_t tx_buffer_[BUFFER_LENGTH];
+  uint8_t tx_length_ = 0;
+  uint8_t rx_buffer_[BUFFER_LENGTH];
+  uint8_t rx_length_ = 0;
+  uint8_t rx_index_ = 0;
+};
+
+extern TwoWire Wire;
+
+#endif /* _SIM_WIRE_H_ */
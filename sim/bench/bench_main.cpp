@@ -0,0 +1,204 @@
+/**************************************************************************/
+/*!
+ *   @file: bench_main.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Benchmark für env:bench. Führt komplette Messzyklen
+ *             (scan -> getInformation -> write -> wait -> read) über
+ *             NFC_THMS_to_Serial gegen den simulierten PN532 aus und zählt je
+ *             Stufe I2C-Bytes/-Transaktionen, PN532-Befehle, RF-Transaktionen
+ *             sowie die Zeit in delay() (sleep) und auf dem Bus (io).
+ *             Ergebnis als JSON auf stdout; Exit-Code 1, wenn eine Stufe
+ *             fehlschlägt.
+ *
+ *             Aufruf: program [Zyklen] [Antwortzeit_Tag_ms]
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PN532_Sim.h"
+#include "NTAG21x_Sim.h"
+#include "Arduino.h"
+#include <DFRobot_PN532.h>
+#include <NFC_THMS_to_Serial.h>
+
+extern nt2s_pn532_t nfc;        // Instanz aus NFC_THMS_to_Serial.cpp
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define BENCH_MESSAGE_LENGTH        81     // Same as MAXIMAL_NDEF_MESSAGE_LENGT in the bridge
+#define BENCH_FIRST_POLL_MS         500    // Same timing as FSM_WAIT_FOR_RESPONSE in the bridge
+#define BENCH_POLL_INTERVAL_MS      250
+#define BENCH_RESPONSE_TIMEOUT_MS   5000
+
+typedef enum {
+  STAGE_SCAN,
+  STAGE_GET_INFORMATION,
+  STAGE_WRITE,
+  STAGE_WAIT,
+  STAGE_READ,
+  NUMBER_OF_STAGES
+}bench_stage_t;
+
+static const char * const stage_names[NUMBER_OF_STAGES] = {"scan", "getInformation", "write", "wait", "read"};
+
+typedef struct {
+  unsigned long long time_us;
+  unsigned long long sleep_us;
+  unsigned long long io_us;
+  unsigned long i2c_bytes_tx;
+  unsigned long i2c_bytes_rx;
+  unsigned long i2c_transactions;
+  unsigned long pn532_commands;
+  unsigned long rf_transactions;
+  bool ok;
+}stage_result_t;
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Stage measurement */
+static unsigned long long stage_start_us_m;
+static sim_stats_t stage_start_stats_m;
+
+static void stage_begin(void) {
+  stage_start_us_m = sim_now_us();
+  stage_start_stats_m = *sim_stats();
+}
+
+static stage_result_t stage_end(bool ok) {
+  const sim_stats_t * s = sim_stats();
+  const sim_stats_t * s0 = &stage_start_stats_m;
+  stage_result_t r;
+  r.time_us = sim_now_us() - stage_start_us_m;
+  r.sleep_us = s->sleep_us - s0->sleep_us;
+  r.io_us = s->io_us - s0->io_us;
+  r.i2c_bytes_tx = s->i2c_bytes_tx - s0->i2c_bytes_tx;
+  r.i2c_bytes_rx = s->i2c_bytes_rx - s0->i2c_bytes_rx;
+  r.i2c_transactions = s->i2c_transactions - s0->i2c_transactions;
+  r.pn532_commands = s->pn532_commands - s0->pn532_commands;
+  r.rf_transactions = s->rf_transactions - s0->rf_transactions;
+  r.ok = ok;
+  return r;
+}
+
+static void stage_add(stage_result_t * sum, const stage_result_t * r) {
+  sum->time_us += r->time_us;
+  sum->sleep_us += r->sleep_us;
+  sum->io_us += r->io_us;
+  sum->i2c_bytes_tx += r->i2c_bytes_tx;
+  sum->i2c_bytes_rx += r->i2c_bytes_rx;
+  sum->i2c_transactions += r->i2c_transactions;
+  sum->pn532_commands += r->pn532_commands;
+  sum->rf_transactions += r->rf_transactions;
+  sum->ok = sum->ok && r->ok;
+}
+
+/* indent: depth of the enclosing JSON object (stage objects of one level line up) */
+static void print_stage(const char * indent, const char * name, const stage_result_t * r, const char * separator) {
+  printf("%s\"%s\": {\"ok\": %s, \"time_us\": %llu, \"sleep_us\": %llu, \"io_us\": %llu, "
+         "\"i2c_bytes_tx\": %lu, \"i2c_bytes_rx\": %lu, \"i2c_transactions\": %lu, "
+         "\"pn532_commands\": %lu, \"rf_transactions\": %lu}%s\n",
+         indent, name, r->ok ? "true" : "false", r->time_us, r->sleep_us, r->io_us,
+         r->i2c_bytes_tx, r->i2c_bytes_rx, r->i2c_transactions,
+         r->pn532_commands, r->rf_transactions, separator);
+}
+/* >> END: Stage measurement */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Measurement cycle */
+/* Wartet wie FSM_WAIT_FOR_RESPONSE, bis der Tag die Do-Instruction ersetzt hat */
+static bool wait_for_response(uint8_t do_instruction) {
+  unsigned long long start_us = sim_now_us();
+  delay(BENCH_FIRST_POLL_MS);
+  while (sim_now_us() - start_us < 1000ULL*BENCH_RESPONSE_TIMEOUT_MS) {
+    uint8_t current;
+    if (NT2S_read_do_instruction(&current) && (current != do_instruction)) return true;
+    delay(BENCH_POLL_INTERVAL_MS);
+  }
+  return false;
+}
+
+static void run_cycle(stage_result_t results[NUMBER_OF_STAGES]) {
+  uint8_t message[BENCH_MESSAGE_LENGTH];
+
+  stage_begin();
+  results[STAGE_SCAN] = stage_end(nfc.scan());
+
+  stage_begin();
+  DFRobot_PN532::sCard_t card = nfc.getInformation();
+  results[STAGE_GET_INFORMATION] = stage_end(DFRobot_PN532::isNTAG(card.type));
+
+  stage_begin();
+  results[STAGE_WRITE] = stage_end(NT2S_set_instruction(NT2S_DO_SINGLE_MEASUREMENT));
+
+  stage_begin();
+  results[STAGE_WAIT] = stage_end(wait_for_response(NT2S_DO_SINGLE_MEASUREMENT));
+
+  stage_begin();
+  results[STAGE_READ] = stage_end(NT2S_read_ndef_text(message, sizeof(message)));
+}
+/* >> END: Measurement cycle */
+
+
+int main(int argc, char ** argv) {
+  unsigned long cycles = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10;
+  unsigned long response_ms = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1500;
+
+  static const uint8_t uid[SIM_TAG_UID_LENGTH] = {0x04, 0x5A, 0x1B, 0x92, 0x3C, 0x6E, 0x80};
+  ThmsTagSim tag(uid);
+  tag.setResponseDelayMs(response_ms);
+  PN532Sim pn532;
+  pn532.addTag(&tag);
+  pn532.attachI2C(2);
+
+  NT2S_set_debug_output(false);   // stdout is reserved for JSON
+  stage_begin();
+  stage_result_t init = stage_end(init_NT2S());
+
+  stage_result_t totals[NUMBER_OF_STAGES];
+  memset(totals, 0, sizeof(totals));
+  for (uint8_t s = 0; s < NUMBER_OF_STAGES; s++) totals[s].ok = true;
+  bool all_ok = init.ok;
+
+  printf("{\n  \"benchmark\": \"thms_measurement_cycle\",\n");
+  printf("  \"cycles\": %lu,\n  \"tag_response_ms\": %lu,\n", cycles, response_ms);
+  printf("  \"init\": {\"ok\": %s, \"time_us\": %llu, \"pn532_commands\": %lu},\n",
+         init.ok ? "true" : "false", init.time_us, init.pn532_commands);
+  printf("  \"results\": [\n");
+  for (unsigned long c = 0; c < cycles; c++) {
+    stage_result_t results[NUMBER_OF_STAGES];
+    stage_result_t cycle_total;
+    memset(&cycle_total, 0, sizeof(cycle_total));
+    cycle_total.ok = true;
+    run_cycle(results);
+    printf("    {\n      \"cycle\": %lu,\n      \"stages\": {\n", c + 1);
+    for (uint8_t s = 0; s < NUMBER_OF_STAGES; s++) {
+      print_stage("        ", stage_names[s], &results[s], (s + 1 < NUMBER_OF_STAGES) ? "," : "");
+      stage_add(&totals[s], &results[s]);
+      stage_add(&cycle_total, &results[s]);
+    }
+    printf("      },\n");
+    print_stage("      ", "total", &cycle_total, "");
+    printf("    }%s\n", (c + 1 < cycles) ? "," : "");
+    all_ok = all_ok && cycle_total.ok;
+  }
+  printf("  ],\n  \"sum\": {\n");
+  stage_result_t grand_total;
+  memset(&grand_total, 0, sizeof(grand_total));
+  grand_total.ok = true;
+  for (uint8_t s = 0; s < NUMBER_OF_STAGES; s++) {
+    print_stage("    ", stage_names[s], &totals[s], ",");
+    stage_add(&grand_total, &totals[s]);
+  }
+  print_stage("    ", "total", &grand_total, "");
+  printf("  },\n  \"ok\": %s\n}\n", all_ok ? "true" : "false");
+  return all_ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*!
+ *   @file: native_main.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Einstiegspunkt für env:native. Verbindet einen simulierten PN532 und
+ *             NFC-THMS-Sensor-Tag mit dem Arduino-Ersatz und führt die unveränderte
+ *             Bridge-Firmware (setup()/loop()) auf der virtuellen Uhr aus.
+ *
+ *             Aufruf: program [Laufzeit_s] [Antwortzeit_Tag_ms] ["<ms>:<Zeile>" ...]
+ *             z.B.    program 30 1500 "100:C:F" "200:M"
+ *             Mit SIM_TAGS=2 liegt ein zweiter Sensor-Tag im Feld (mit 32 Byte Wire-
+ *             Puffer nacheinander gelistet, siehe PN532_IIC_MAX_TARGETS).
+ *             Am Ende werden Bus-Verkehr und Zeiten auf stderr ausgegeben.
+ *             Bei "pio test -e native" bringt jeder Test sein eigenes main() mit.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "PN532_Sim.h"
+#include "NTAG21x_Sim.h"
+#include "Arduino.h"
+
+#ifndef PIO_UNIT_TESTING
+void setup(void);
+void loop(void);
+
+typedef struct {
+  unsigned long at_ms;
+  std::string line;
+}scripted_input_t;
+
+int main(int argc, char ** argv) {
+  unsigned long run_s = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20;
+  unsigned long response_ms = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1500;
+  std::vector<scripted_input_t> script;
+  for (int i = 3; i < argc; i++) {
+    const char * colon = strchr(argv[i], ':');
+    if (colon == NULL) continue;
+    scripted_input_t entry = {strtoul(argv[i], NULL, 10), std::string(colon + 1) + "\n"};
+    script.push_back(entry);
+  }
+
+  static const uint8_t uid[SIM_TAG_UID_LENGTH] = {0x04, 0x5A, 0x1B, 0x92, 0x3C, 0x6E, 0x80};
+  static const uint8_t uid2[SIM_TAG_UID_LENGTH] = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x80};
+  const char * sim_tags = getenv("SIM_TAGS");
+  bool second_tag = (sim_tags != NULL) && (atoi(sim_tags) >= 2);
+  ThmsTagSim tag(uid);
+  ThmsTagSim tag2(uid2);
+  tag.setResponseDelayMs(response_ms);
+  tag2.setResponseDelayMs(response_ms);
+  tag2.setMeasurement(321, 654, 987);
+  PN532Sim pn532;
+  pn532.addTag(&tag);
+  if (second_tag) pn532.addTag(&tag2);
+  pn532.attachI2C(2);
+
+  setup();
+  size_t next_input = 0;
+  while (sim_now_us() < 1000000ULL*run_s) {
+    while ((next_input < script.size()) && (sim_now_us() >= 1000ULL*script[next_input].at_ms)) {
+      sim_serial_inject(script[next_input++].line.c_str());
+    }
+    loop();
+  }
+  fflush(stdout);
+
+  sim_stats_t * s = sim_stats();
+  fprintf(stderr, "virtual_time_ms=%llu measurements=%lu tag_page_writes=%lu\n",
+          sim_now_us()/1000ULL, tag.measurementCount(), tag.writeCount());
+  if (second_tag) {
+    fprintf(stderr, "tag2: measurements=%lu tag_page_writes=%lu\n", tag2.measurementCount(), tag2.writeCount());
+  }
+  fprintf(stderr, "i2c_tx=%lu i2c_rx=%lu i2c_transactions=%lu pn532_commands=%lu rf_transactions=%lu sleep_ms=%llu io_ms=%llu\n",
+          s->i2c_bytes_tx, s->i2c_bytes_rx, s->i2c_transactions, s->pn532_commands, s->rf_transactions,
+          s->sleep_us/1000ULL, s->io_us/1000ULL);
+  return 0;
+}
+#endif /* PIO_UNIT_TESTING */
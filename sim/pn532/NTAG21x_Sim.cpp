@@ -0,0 +1,178 @@
+/**************************************************************************/
+/*!
+ *   @file: NTAG21x_Sim.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Simulierte NTAG213/215/216 und NFC-THMS-Sensor-Tag.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "NTAG21x_Sim.h"
+#include "SimHooks.h"
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define NTAG_CMD_GET_VERSION    0x60
+#define NTAG_CMD_READ           0x30
+#define NTAG_CMD_FAST_READ      0x3A
+#define NTAG_CMD_WRITE          0xA2
+#define NTAG_CMD_COMP_WRITE     0xA0
+
+#define THMS_DO_PAGE_LAST       9     // Bridge writes pages 4..9 for a Do-instruction
+#define THMS_SILENT_TIME_US     1000000ULL
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: SimTag */
+SimTag::SimTag(const uint8_t uid[SIM_TAG_UID_LENGTH], uint8_t atqa_hi, uint8_t atqa_lo, uint8_t sak)
+  : sak_(sak), present_(true), active_(false), halted_(false) {
+  memcpy(uid_, uid, SIM_TAG_UID_LENGTH);
+  atqa_[0] = atqa_hi;
+  atqa_[1] = atqa_lo;
+}
+/* >> END: SimTag */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Ntag21xSim */
+Ntag21xSim::Ntag21xSim(type_t type, const uint8_t uid[SIM_TAG_UID_LENGTH])
+  : SimTag(uid, 0x00, 0x44, 0x00), type_(type), last_command_us_(0), write_count_(0) {
+  size_t pages = (type == NTAG213) ? 45 : ((type == NTAG215) ? 135 : 231);
+  uint8_t cc_size = (type == NTAG213) ? 0x12 : ((type == NTAG215) ? 0x3E : 0x6D);
+  memory_.assign(4*pages, 0x00);
+  uint8_t * p = &memory_[0];
+  p[0] = uid[0]; p[1] = uid[1]; p[2] = uid[2]; p[3] = (uint8_t)(0x88 ^ uid[0] ^ uid[1] ^ uid[2]);
+  p[4] = uid[3]; p[5] = uid[4]; p[6] = uid[5]; p[7] = uid[6];
+  p[8] = (uint8_t)(uid[3] ^ uid[4] ^ uid[5] ^ uid[6]); p[9] = 0x48;
+  p[12] = 0xE1; p[13] = 0x10; p[14] = cc_size; p[15] = 0x00;
+  p[16] = 0x03; p[17] = 0x00; p[18] = 0xFE;   // Empty NDEF message
+}
+
+bool Ntag21xSim::transceive(const uint8_t * command, size_t length, std::vector<uint8_t> & response) {
+  response.clear();
+  last_command_us_ = 0;
+  if (!active_ || (length == 0)) return false;
+  size_t pages = pageCount();
+  switch (command[0]) {
+    case NTAG_CMD_GET_VERSION: {
+      const uint8_t storage = (type_ == NTAG213) ? 0x0F : ((type_ == NTAG215) ? 0x11 : 0x13);
+      const uint8_t version[8] = {0x00, 0x04, 0x04, 0x02, 0x01, 0x00, storage, 0x03};
+      response.assign(version, version + 8);
+      return true;
+    }
+    case NTAG_CMD_READ: {
+      if ((length < 2) || (command[1] >= pages)) break;
+      for (size_t i = 0; i < 16; i++) response.push_back(memory_[(4*command[1] + i) % memory_.size()]);
+      return true;
+    }
+    case NTAG_CMD_FAST_READ: {
+      if ((length < 3) || (command[1] > command[2]) || (command[2] >= pages)) break;
+      response.assign(memory_.begin() + 4*command[1], memory_.begin() + 4*(command[2] + 1));
+      return true;
+    }
+    case NTAG_CMD_WRITE: {
+      uint8_t page_no = command[1];
+      if ((length < 6) || (page_no < 2) || (page_no >= pages)) break;
+      uint8_t * p = page(page_no);
+      if (page_no == 2) { p[2] |= command[4]; p[3] |= command[5]; }
+      else if (page_no == 3) { for (int i = 0; i < 4; i++) p[i] |= command[2 + i]; }
+      else memcpy(p, &command[2], 4);
+      last_command_us_ = SIM_NTAG_WRITE_TIME_US;
+      write_count_++;
+      onPageWritten(page_no);
+      return true;   // 4-bit ACK
+    }
+    default: break;
+  }
+  active_ = false;   // NAK: tag falls back to IDLE state
+  return false;
+}
+
+void Ntag21xSim::writeNdefText(const char * text, const char * language) {
+  size_t text_length = strlen(text);
+  size_t language_length = strlen(language);
+  size_t payload_length = 1 + language_length + text_length;
+  size_t message_length = 4 + payload_length;
+  std::vector<uint8_t> tlv;
+  tlv.push_back(0x03);
+  tlv.push_back((uint8_t)message_length);
+  tlv.push_back(0xD1); tlv.push_back(0x01); tlv.push_back((uint8_t)payload_length); tlv.push_back('T');
+  tlv.push_back((uint8_t)language_length);
+  tlv.insert(tlv.end(), language, language + language_length);
+  tlv.insert(tlv.end(), text, text + text_length);
+  tlv.push_back(0xFE);
+  if (16 + tlv.size() > memory_.size()) return;
+  memcpy(&memory_[16], &tlv[0], tlv.size());
+}
+
+std::string Ntag21xSim::readNdefText(void) const {
+  size_t i = 16;
+  while ((i < memory_.size()) && (memory_[i] == 0x00)) i++;   // NULL TLVs
+  if ((i + 8 >= memory_.size()) || (memory_[i] != 0x03)) return std::string();
+  const uint8_t * record = &memory_[i + 2];
+  if ((record[1] != 0x01) || (record[3] != 'T')) return std::string();
+  size_t payload_length = record[2];
+  size_t language_length = record[4] & 0x3F;
+  if (i + 2 + 4 + payload_length > memory_.size()) return std::string();
+  return std::string((const char *)&record[5 + language_length], payload_length - 1 - language_length);
+}
+/* >> END: Ntag21xSim */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: ThmsTagSim */
+ThmsTagSim::ThmsTagSim(const uint8_t uid[SIM_TAG_UID_LENGTH], type_t type)
+  : Ntag21xSim(type, uid), pending_instruction_(-1), due_us_(0), silent_until_us_(0),
+    response_delay_us_(1500000ULL), sequence_no_(0), ss_(123), ms_(456), rsqpb_(1203) {
+  writeNdefText("Do:01;");
+}
+
+void ThmsTagSim::onPageWritten(uint8_t page_no) {
+  if (page_no > THMS_DO_PAGE_LAST) return;
+  std::string text = readNdefText();
+  unsigned int instruction;
+  if ((text.size() < 5) || (sscanf(text.c_str(), "Do:%2x", &instruction) != 1)) return;
+  if ((instruction == 0x00) || (instruction == 0x01) || (instruction == 0xFF)) return;
+  pending_instruction_ = (int)instruction;
+  due_us_ = sim_now_us() + response_delay_us_;
+}
+
+void ThmsTagSim::poll(unsigned long long now_us) {
+  if ((silent_until_us_ != 0) && (now_us >= silent_until_us_)) {
+    silent_until_us_ = 0;
+    setPresent(true);
+  }
+  if ((pending_instruction_ < 0) || (now_us < due_us_)) return;
+  char text[80];
+  switch (pending_instruction_) {
+    case 0x02:
+      sequence_no_++;
+      snprintf(text, sizeof(text), "Do:01;No:%lu;SS:%u;MS:%u;RSQPB:%u;", sequence_no_, ss_, ms_, rsqpb_);
+      ss_ += 1; ms_ += 2; rsqpb_ += 3;
+      break;
+    case 0x04:
+      snprintf(text, sizeof(text), "Do:01;");
+      silent_until_us_ = now_us + THMS_SILENT_TIME_US;
+      setPresent(false);
+      break;
+    case 0x05:
+      snprintf(text, sizeof(text), "Do:01;");
+      break;
+    case 0x06:
+      snprintf(text, sizeof(text), "Do:01;PL:100;ST:1;MT:2;FW:1.3;");
+      break;
+    default:
+      snprintf(text, sizeof(text), "Do:FF;");
+      break;
+  }
+  pending_instruction_ = -1;
+  writeNdefText(text);
+}
+/* >> END: ThmsTagSim */
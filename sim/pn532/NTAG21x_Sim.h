@@ -0,0 +1,116 @@
+/**************************************************************************/
+/*!
+ *   @file: NTAG21x_Sim.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Simulierte ISO14443-3A Typ-2-Tags für den PN532-Simulator:
+ *             Speicher von NTAG213/215/216 mit READ, FAST_READ, WRITE und
+ *             GET_VERSION sowie ein skriptbarer NFC-THMS-Sensor-Tag, der
+ *             "Do:"-Instruktionen nach einstellbarer Verzögerung beantwortet.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _NTAG21X_SIM_H_
+#define _NTAG21X_SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define SIM_TAG_UID_LENGTH          7
+#define SIM_NTAG_WRITE_TIME_US      4100UL   // EEPROM programming time of one page (NTAG21x datasheet)
+#define SIM_RF_US_PER_BYTE          85UL     // 106 kbit/s incl. parity
+
+/* Base class for everything the simulated PN532 can select */
+class SimTag {
+public:
+  SimTag(const uint8_t uid[SIM_TAG_UID_LENGTH], uint8_t atqa_hi, uint8_t atqa_lo, uint8_t sak);
+  virtual ~SimTag() {}
+
+  /* Executes one RF command. Returns false for NAK/no answer; the tag then
+     falls back to IDLE and has to be selected again. */
+  virtual bool transceive(const uint8_t * command, size_t length, std::vector<uint8_t> & response) = 0;
+  /* Extra tag-side processing time of the last command (e.g. EEPROM write) */
+  virtual unsigned long lastCommandTimeUs(void) const { return 0; }
+  /* Time driven behaviour (scripted answers, field silence, ...) */
+  virtual void poll(unsigned long long now_us) { (void)now_us; }
+
+  bool present(void) const { return present_; }
+  void setPresent(bool present) { present_ = present; if (!present) active_ = halted_ = false; }
+  bool active(void) const { return active_; }
+  void setActive(bool active) { active_ = active && present_; }
+  /* HALT state: no answer to REQA (InListPassiveTarget) until the field is reset */
+  bool halted(void) const { return halted_; }
+  void setHalted(bool halted) { halted_ = halted && present_; if (halted) active_ = false; }
+  const uint8_t * uid(void) const { return uid_; }
+  uint8_t uidLength(void) const { return SIM_TAG_UID_LENGTH; }
+  uint8_t atqa(uint8_t index) const { return atqa_[index]; }
+  uint8_t sak(void) const { return sak_; }
+
+protected:
+  uint8_t uid_[SIM_TAG_UID_LENGTH];
+  uint8_t atqa_[2];
+  uint8_t sak_;
+  bool present_;
+  bool active_;
+  bool halted_;
+};
+
+class Ntag21xSim : public SimTag {
+public:
+  typedef enum { NTAG213, NTAG215, NTAG216 } type_t;
+
+  Ntag21xSim(type_t type, const uint8_t uid[SIM_TAG_UID_LENGTH]);
+
+  bool transceive(const uint8_t * command, size_t length, std::vector<uint8_t> & response);
+  unsigned long lastCommandTimeUs(void) const { return last_command_us_; }
+
+  size_t pageCount(void) const { return memory_.size()/4; }
+  uint8_t * page(size_t page) { return &memory_[4*page]; }
+  /* Stores text as NDEF text record (same layout as the bridge writes) */
+  void writeNdefText(const char * text, const char * language = "de");
+  /* Extracts the first NDEF text record; empty if none */
+  std::string readNdefText(void) const;
+  unsigned long writeCount(void) const { return write_count_; }
+
+protected:
+  virtual void onPageWritten(uint8_t page) { (void)page; }
+
+  type_t type_;
+  std::vector<uint8_t> memory_;
+  unsigned long last_command_us_;
+  unsigned long write_count_;
+};
+
+/* NFC-THMS-Sensor-Tag: reacts on "Do:XX" written by the bridge */
+class ThmsTagSim : public Ntag21xSim {
+public:
+  ThmsTagSim(const uint8_t uid[SIM_TAG_UID_LENGTH], type_t type = NTAG213);
+
+  void poll(unsigned long long now_us);
+  /* Time between the instruction write and the answer of the tag */
+  void setResponseDelayMs(unsigned long delay_ms) { response_delay_us_ = 1000ULL*delay_ms; }
+  void setMeasurement(unsigned int ss, unsigned int ms, unsigned int rsqpb) { ss_ = ss; ms_ = ms; rsqpb_ = rsqpb; }
+  unsigned long measurementCount(void) const { return sequence_no_; }
+  bool busy(void) const { return pending_instruction_ >= 0; }
+
+protected:
+  void onPageWritten(uint8_t page);
+
+private:
+  int pending_instruction_;
+  unsigned long long due_us_;
+  unsigned long long silent_until_us_;
+  unsigned long long response_delay_us_;
+  unsigned long sequence_no_;
+  unsigned int ss_, ms_, rsqpb_;
+};
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+#endif /* _NTAG21X_SIM_H_ */
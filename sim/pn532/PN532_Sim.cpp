@@ -0,0 +1,287 @@
+/**************************************************************************/
+/*!
+ *   @file: PN532_Sim.cpp
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Modell des NFC-Controllers PN532 (I2C und HSU) für den Host.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+
+#include "PN532_Sim.h"
+#include "Arduino.h"
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define PN532_TFI_HOST          0xD4
+#define PN532_TFI_PN532         0xD5
+#define PN532_RF_TIMEOUT_US     5000UL   // No answer from a (removed) target
+#define PN532_RF_OVERHEAD_US    1000UL   // PN532 firmware + RF framing per exchange
+#define PN532_ACK_DELAY_US      100UL
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Setup */
+PN532Sim::PN532Sim(void)
+  : target_count_(0), passive_activation_retries_(0xFF), field_on_(true), response_ready_us_(0),
+    ack_pending_(false), response_pending_(false), uart_(NULL), baud_(115200),
+    mcu_baud_(115200), pending_baud_(0) {
+  static const uint8_t ack[6] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+  ack_frame_.assign(ack, ack + 6);
+  for (uint8_t i = 0; i < SIM_PN532_MAX_TARGETS; i++) targets_[i] = NULL;
+}
+
+void PN532Sim::attachI2C(uint8_t irq_pin) {
+  sim_attach_i2c(SIM_PN532_I2C_ADDRESS, this);
+  sim_attach_pin(irq_pin, this);
+}
+
+void PN532Sim::attachUart(HardwareSerial * uart) {
+  uart_ = uart;
+  uart->attach(this);
+  mcu_baud_ = uart->baud();
+}
+/* >> END: Setup */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Frame handling */
+std::vector<uint8_t> PN532Sim::buildFrame(const uint8_t * payload, size_t length) {
+  std::vector<uint8_t> frame;
+  uint8_t checksum = 0;
+  frame.push_back(0x00); frame.push_back(0x00); frame.push_back(0xFF);
+  frame.push_back((uint8_t)length);
+  frame.push_back((uint8_t)(0x100 - (uint8_t)length));
+  for (size_t i = 0; i < length; i++) { frame.push_back(payload[i]); checksum += payload[i]; }
+  frame.push_back((uint8_t)(0x100 - checksum));
+  frame.push_back(0x00);
+  return frame;
+}
+
+void PN532Sim::pollTags(void) {
+  for (size_t i = 0; i < tags_.size(); i++) tags_[i]->poll(sim_now_us());
+}
+
+bool PN532Sim::frameReady(void) {
+  return ack_pending_ || (response_pending_ && (sim_now_us() >= response_ready_us_));
+}
+
+void PN532Sim::queueFrame(const std::vector<uint8_t> & frame, unsigned long long ready_at_us, bool is_ack) {
+  if (is_ack) { ack_pending_ = true; return; }
+  response_frame_ = frame;
+  response_ready_us_ = ready_at_us;
+  response_pending_ = true;
+}
+
+/* data starts at the first preamble/start code byte */
+void PN532Sim::handleHostFrame(const uint8_t * data, size_t length) {
+  size_t i = 0;
+  while ((i + 1 < length) && !((data[i] == 0x00) && (data[i + 1] == 0xFF))) i++;
+  if (i + 3 >= length) return;
+  uint8_t len = data[i + 2];
+  uint8_t lcs = data[i + 3];
+  if ((len == 0x00) && (lcs == 0xFF)) {              // ACK from host: abort running command
+    ack_pending_ = false;
+    response_pending_ = false;
+    if (pending_baud_ != 0) { baud_ = pending_baud_; pending_baud_ = 0; }
+    return;
+  }
+  if ((len == 0xFF) && (lcs == 0x00)) {              // NACK from host: send last response again
+    if (!last_response_.empty()) queueFrame(last_response_, sim_now_us(), false);
+    return;
+  }
+  if ((uint8_t)(len + lcs) != 0x00) return;          // Length checksum error: frame ignored
+  if (i + 4 + len >= length) return;
+  const uint8_t * payload = &data[i + 4];
+  uint8_t sum = 0;
+  for (uint8_t k = 0; k < len; k++) sum += payload[k];
+  if ((uint8_t)(sum + data[i + 4 + len]) != 0x00) return;   // Data checksum error
+  if ((len < 2) || (payload[0] != PN532_TFI_HOST)) return;
+
+  sim_stats()->pn532_commands++;
+  std::vector<uint8_t> response;
+  unsigned long long time_us = SIM_PN532_CMD_TIME_US;
+  execute(&payload[1], len - 1, response, time_us);
+  ack_pending_ = true;
+  response_pending_ = false;
+  if (!response.empty()) queueFrame(buildFrame(&response[0], response.size()), sim_now_us() + time_us, false);
+}
+/* >> END: Frame handling */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Command execution */
+void PN532Sim::execute(const uint8_t * command, size_t length, std::vector<uint8_t> & response, unsigned long long & time_us) {
+  pollTags();
+  response.push_back(PN532_TFI_PN532);
+  response.push_back((uint8_t)(command[0] + 1));
+  switch (command[0]) {
+    case 0x02:   // GetFirmwareVersion
+      response.push_back(0x32); response.push_back(0x01); response.push_back(0x06); response.push_back(0x07);
+      break;
+    case 0x14:   // SAMConfiguration
+      break;
+    case 0x32:   // RFConfiguration
+      if ((length >= 5) && (command[1] == 0x05)) passive_activation_retries_ = command[4];
+      if ((length >= 3) && (command[1] == 0x01)) {   // RF field: off resets every tag to IDLE
+        field_on_ = (command[2] & 0x01) != 0;
+        for (size_t k = 0; k < tags_.size(); k++) { tags_[k]->setActive(false); tags_[k]->setHalted(false); }
+        target_count_ = 0;
+      }
+      break;
+    case 0x10: { // SetSerialBaudRate: takes effect after the ACK of the host
+      static const unsigned long rates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1288000};
+      if ((length < 2) || (command[1] > 8)) { response.clear(); response.push_back(0x7F); break; }
+      pending_baud_ = rates[command[1]];
+      break;
+    }
+    case 0x4A: { // InListPassiveTarget
+      uint8_t max_tg = (length >= 2) ? command[1] : 1;
+      if ((max_tg == 0) || (max_tg > SIM_PN532_MAX_TARGETS) || (length < 3) || (command[2] != 0x00)) {
+        response.clear(); response.push_back(0x7F); break;
+      }
+      // ISO14443-3: an ACTIVE tag takes REQA as error and falls back to IDLE without answering.
+      // It answers only the next REQA, i.e. when no other tag answered and the PN532 retries.
+      SimTag * previous[SIM_PN532_MAX_TARGETS];
+      uint8_t previous_count = target_count_;
+      for (uint8_t t = 0; t < target_count_; t++) { previous[t] = targets_[t]; targets_[t]->setActive(false); }
+      target_count_ = 0;
+      sim_stats()->rf_transactions++;
+      size_t count_index = response.size();
+      response.push_back(0);
+      bool retried = false;
+      for (size_t k = 0; (k < tags_.size()) && (target_count_ < max_tg); k++) {
+        SimTag * tag = tags_[k];
+        if (!field_on_ || !tag->present() || tag->halted()) continue;
+        bool was_active = false;
+        for (uint8_t t = 0; t < previous_count; t++) was_active = was_active || (previous[t] == tag);
+        if (was_active && !retried) {
+          bool other = false;   // Another tag answers the first REQA
+          for (size_t o = 0; o < tags_.size(); o++) {
+            bool o_active = false;
+            for (uint8_t t = 0; t < previous_count; t++) o_active = o_active || (previous[t] == tags_[o]);
+            other = other || (!o_active && tags_[o]->present() && !tags_[o]->halted());
+          }
+          if (other || (passive_activation_retries_ == 0)) continue;
+          retried = true;
+        }
+        tag->setActive(true);
+        targets_[target_count_++] = tag;
+        response.push_back(target_count_);
+        response.push_back(tag->atqa(0)); response.push_back(tag->atqa(1));
+        response.push_back(tag->sak());
+        response.push_back(tag->uidLength());
+        response.insert(response.end(), tag->uid(), tag->uid() + tag->uidLength());
+      }
+      response[count_index] = target_count_;
+      if (target_count_ == 0) {
+        if (passive_activation_retries_ == 0xFF) { response.clear(); return; }   // Retries forever
+        time_us = (unsigned long long)SIM_PN532_ACTIVATION_US*(passive_activation_retries_ + 1U);
+      } else {
+        time_us = (unsigned long long)SIM_PN532_ACTIVATION_US*(target_count_ + (retried ? 1 : 0));
+      }
+      break;
+    }
+    case 0x40:   // InDataExchange
+    case 0x42: { // InCommunicateThru
+      bool exchange = (command[0] == 0x40);
+      uint8_t tg = exchange ? (uint8_t)((length >= 2) ? (command[1] & 0x0F) : 0) : 1;
+      const uint8_t * data = exchange ? &command[2] : &command[1];
+      size_t data_length = (length > (size_t)(exchange ? 2 : 1)) ? length - (exchange ? 2 : 1) : 0;
+      if ((tg == 0) || (tg > target_count_) || (data_length == 0)) { response.push_back(0x27); break; }
+      SimTag * tag = targets_[tg - 1];
+      sim_stats()->rf_transactions++;
+      std::vector<uint8_t> answer;
+      if (!tag->present() || !tag->transceive(data, data_length, answer)) {
+        response.push_back(0x01);    // Timeout: target did not answer
+        time_us = PN532_RF_TIMEOUT_US;
+        break;
+      }
+      response.push_back(0x00);
+      response.insert(response.end(), answer.begin(), answer.end());
+      time_us = PN532_RF_OVERHEAD_US + (data_length + answer.size())*SIM_RF_US_PER_BYTE + tag->lastCommandTimeUs();
+      break;
+    }
+    case 0x52: { // InRelease: type 2 tags (no ISO14443-4) get a HLTA
+      uint8_t tg = (length >= 2) ? command[1] : 0;
+      for (uint8_t t = 0; t < target_count_; t++) {
+        if ((tg == 0) || (tg == t + 1)) targets_[t]->setHalted((targets_[t]->sak() & 0x20) == 0);
+        if ((tg == 0) || (tg == t + 1)) targets_[t]->setActive(false);
+      }
+      response.push_back(0x00);
+      break;
+    }
+    default:     // Application level error frame
+      response.clear();
+      response.push_back(0x7F);
+      break;
+  }
+}
+/* >> END: Command execution */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: I2C */
+void PN532Sim::i2cWrite(const uint8_t * data, size_t length) {
+  pollTags();
+  handleHostFrame(data, length);
+}
+
+size_t PN532Sim::i2cRead(uint8_t * buffer, size_t length) {
+  pollTags();
+  memset(buffer, 0x00, length);
+  if (length == 0) return 0;
+  if (!frameReady()) return length;                  // Status byte 0x00: busy
+  buffer[0] = 0x01;
+  if (length == 1) return length;                    // Status poll only, frame stays
+  const std::vector<uint8_t> & frame = ack_pending_ ? ack_frame_ : response_frame_;
+  size_t n = (frame.size() < length - 1) ? frame.size() : length - 1;
+  memcpy(&buffer[1], &frame[0], n);
+  if (ack_pending_) {
+    ack_pending_ = false;
+  } else {
+    last_response_ = response_frame_;
+    response_pending_ = false;
+  }
+  return length;
+}
+/* >> END: I2C */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: HSU */
+void PN532Sim::uartReceive(uint8_t data) {
+  if (mcu_baud_ != baud_) return;                    // Wrong baud rate: byte is garbage for the PN532
+  uart_rx_.push_back(data);
+  /* Complete frame? (00 FF LEN LCS ... DCS) */
+  size_t i = 0;
+  while ((i + 1 < uart_rx_.size()) && !((uart_rx_[i] == 0x00) && (uart_rx_[i + 1] == 0xFF))) i++;
+  if (i + 3 >= uart_rx_.size()) return;
+  uint8_t len = uart_rx_[i + 2];
+  uint8_t lcs = uart_rx_[i + 3];
+  size_t needed = (((len == 0x00) && (lcs == 0xFF)) || ((len == 0xFF) && (lcs == 0x00))) ? i + 4 : i + 4 + len + 1;
+  if (uart_rx_.size() < needed) return;
+  handleHostFrame(&uart_rx_[0], uart_rx_.size());
+  uart_rx_.clear();
+}
+
+void PN532Sim::uartPoll(void) {
+  if (uart_ == NULL) return;
+  pollTags();
+  if (mcu_baud_ != baud_) return;
+  if (ack_pending_) {
+    ack_pending_ = false;
+    for (size_t i = 0; i < ack_frame_.size(); i++) uart_->deliver(ack_frame_[i]);
+  }
+  if (response_pending_ && (sim_now_us() >= response_ready_us_)) {
+    response_pending_ = false;
+    last_response_ = response_frame_;
+    for (size_t i = 0; i < response_frame_.size(); i++) uart_->deliver(response_frame_[i]);
+  }
+}
+/* >> END: HSU */
@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*!
+ *   @file: PN532_Sim.h
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Modell des NFC-Controllers PN532 für den Host. Spricht das
+ *             PN532-Frame-Protokoll über I2C (Statusbyte, ACK, NACK-Wiederholung,
+ *             IRQ-Leitung) und HSU (Wake-up-Präambel, SetSerialBaudRate) und führt
+ *             SAMConfiguration, RFConfiguration, GetFirmwareVersion,
+ *             InListPassiveTarget, InDataExchange, InCommunicateThru und
+ *             InRelease auf simulierten Tags aus.
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#ifndef _PN532_SIM_H_
+#define _PN532_SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "SimHooks.h"
+#include "NTAG21x_Sim.h"
+
+class HardwareSerial;
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define SIM_PN532_I2C_ADDRESS       0x24
+#define SIM_PN532_MAX_TARGETS       2     // InListPassiveTarget MaxTg limit of the PN532
+#define SIM_PN532_CMD_TIME_US       500UL // Internal command handling
+#define SIM_PN532_ACTIVATION_US     5000UL // One passive activation attempt (REQA..SELECT)
+
+class PN532Sim : public SimI2CDevice, public SimUartDevice, public SimPinSource {
+public:
+  PN532Sim(void);
+
+  void addTag(SimTag * tag) { tags_.push_back(tag); }
+  void attachI2C(uint8_t irq_pin);                 // Registers at SIM_PN532_I2C_ADDRESS (+ IRQ pin)
+  void attachUart(HardwareSerial * uart);          // HSU mode on the given MCU UART
+
+  /* SimI2CDevice */
+  void i2cWrite(const uint8_t * data, size_t length);
+  size_t i2cRead(uint8_t * buffer, size_t length);
+  /* SimUartDevice */
+  void uartReceive(uint8_t data);
+  void uartSetBaud(unsigned long baud) { mcu_baud_ = baud; }
+  void uartPoll(void);
+  /* SimPinSource: IRQ is active low while a frame is ready */
+  int pinLevel(void) { pollTags(); return frameReady() ? 0 : 1; }
+
+  unsigned long baud(void) const { return baud_; }
+
+private:
+  void pollTags(void);
+  bool frameReady(void);
+  void handleHostFrame(const uint8_t * data, size_t length);
+  void execute(const uint8_t * command, size_t length, std::vector<uint8_t> & response, unsigned long long & time_us);
+  void queueFrame(const std::vector<uint8_t> & frame, unsigned long long ready_at_us, bool is_ack);
+  static std::vector<uint8_t> buildFrame(const uint8_t * payload, size_t length);
+
+  std::vector<SimTag *> tags_;
+  SimTag * targets_[SIM_PN532_MAX_TARGETS];
+  uint8_t target_count_;
+  uint8_t passive_activation_retries_;
+  bool field_on_;
+
+  /* Output side: ACK first, response after processing time */
+  std::vector<uint8_t> ack_frame_;
+  std::vector<uint8_t> response_frame_;
+  std::vector<uint8_t> last_response_;
+  unsigned long long response_ready_us_;
+  bool ack_pending_;
+  bool response_pending_;
+
+  /* HSU */
+  HardwareSerial * uart_;
+  std::vector<uint8_t> uart_rx_;
+  unsigned long baud_;
+  unsigned long mcu_baud_;
+  unsigned long pending_baud_;
+};
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+#endif /* _PN532_SIM_H_ */
@@ -1,6 +1,17 @@
-#include <stdio.h>
 #include <stdbool.h> 
+#include <ctype.h>
 #include <NFC_THMS_to_Serial.h>
+#include <THMS_Scheduler.h>
+#include <THMS_Line_Buffer.h>
+#include <THMS_Binary_Frame.h>
+#include <THMS_Message.h>
+#include <THMS_Measurement_Log.h>
+#include <THMS_Profile.h>
+#include <THMS_Retry.h>
+#include <THMS_Serial_Out.h>
+#include <THMS_Log.h>
+#include <THMS_Format.h>
+#include <THMS_Command_Queue.h>
 //#include <SoftwareReset.h>
 
 // Version: V1.4
@@ -8,24 +19,32 @@
 /*----------- ToDo -------------*/
 //  - Handling serial conmmands to
 //    - Instruction to reset and reboot.
-//  - Check if measurement is complete in ndef-text (!= Do: 2)
-//  - Check error messages from tag (== Do:FF ???)
 //  - Reset of TAG (Power-cycle NFC-Field)
 //  - Check if Do-Instruction is valid???
 
 
 /*----------- CONFIGURATION -------------*/
-#define FSM_SLOWDOWN                        500    // Slowdown of Finite-State-Machine in ms
+#define FSM_SLOWDOWN                        500    // Slowdown of Finite-State-Machine in ms (while idle)
+#define SENSOR_SEARCH_TRIES                 5      // Tries to find the sensor before "connection lost"
+#define SENSOR_SEARCH_MIN_BACKOFF_MS        250    // First wait between two tries to find the sensor (doubles per try)
+#define SENSOR_SEARCH_MAX_BACKOFF_MS        2000   // Longest wait between two tries to find the sensor
+#define RESPONSE_FIRST_POLL_MS              500    // Time before the "Do:"-field is polled the first time
+#define RESPONSE_POLL_INTERVAL_MS           250    // Time between two polls of the "Do:"-field
+#define RESPONSE_TIMEOUT_MS                 5000   // Maximal time for the tag to process a Do-instruction (Data is read anyway)
 #define DEFAULT_FOR_CONTINUOUS_MEASUREMENT  true   // Default setup to do continuous measurement.
 #define DEFAULT_MEASUREMENT_INTERVAL_IN_S   120    // Default interval for continuouse measurementv
-// DEBUG CONFIGURATION: To print debug infos beginning with ">>> "
+#define DEFAULT_FOR_BINARY_OUTPUT           false  // Default output: false = text lines, true = binary frames (COBS + CRC16)
+#define PRINT_UID_WITH_TAG_DATA             true   // Text output: "UID:<hex>;" in front of every tag message (several sensor-tags)
+// DEBUG CONFIGURATION: To print debug infos beginning with ">>> " (runtime default, "D:<hex>" changes it).
+// Only levels compiled in with THMS_LOG_LEVELS (see platformio.ini) can be printed.
 #define PRINT_DEBUG_INFO_ERROR              true   // To print errors via uart.
 #define PRINT_DEBUG_INFO_STANDAR            true   // To print standard info via uart.
 #define PRINT_DEBUG_INFO_FSM                false   // To print FSM-State info via uart.
 #define PRINT_NEXT_MEASUREMENT_INFO         false   // To print time to next measurement in seconds via uart.
 #define PRINT_EXTENDED_INFO                 false   // To print some extended standard info via uart.
 
-#define MAXIMAL_INFO_MESSAGE_LENGT    81
+#define MAXIMAL_SERIAL_INSTRUCTION_LENGT  50   // Longer serial instructions are rejected
+#define SERIAL_INSTRUCTIONS_PER_PASS  4        // Maximal number of received lines / executed commands per loop
 #define MAXIMAL_NDEF_MESSAGE_LENGT    81
 
 /*---------------------------------------*/
@@ -39,19 +58,10 @@ typedef enum {
   FSM_READ_TAG_DATA             = 0x04,
   FSM_WRITE_DATA                = 0x05,
   FSM_CHANGE_CONFIG             = 0x06,
+  FSM_WAIT_FOR_RESPONSE         = 0x07,
   FSM_ERROR                     = 0xFF
 }finite_state_machine_state_t;
 
-//Debug infos via uart. Each info has own bit.
-typedef enum {
-  INFO_ERROR_INFO               = (0x1 << 0), // Info about errors
-  INFO_STANDARD_INFO            = (0x1 << 1), // Standard infos
-  INFO_FSM_STATE                = (0x1 << 2), // Info about actual FMS-State
-  INFO_NEXT_MEASUREMENT_INFO    = (0x1 << 3), // Time to next Measurement in s
-  INFO_EXTENDED_INFO            = (0x1 << 4), // Time to next Measurement in s
-  INFO_ALWAYS                   = 0xFF
-}uart_debug_info_t;
-
 //Error types. Should be at least uint16_t. Each error has own bit. 
 typedef enum {
   ERROR_NO_ERROR                = 0x0,
@@ -62,20 +72,55 @@ typedef enum {
   ERROR_SENSOR_CONNECTION_LOST  = (0x1 << 5), // = 0x0020
   ERROR_GET_DATA                = (0x1 << 6), // = 0x0040
   ERROR_SERIAL_INPUT            = (0x1 << 7), // = 0x0080
+  ERROR_TAG_ERROR_REPLY         = (0x1 << 8), // = 0x0100  Tag answered "Do:FF"
+  ERROR_COMMAND_QUEUE_FULL      = (0x1 << 9), // = 0x0200  Serial instruction rejected, CMDQ_SIZE - 1 commands waiting
   ERROR_UNKNOWN                 = (0x1 << 15) // = 0x8000
 }error_indicator_t;
 
 typedef enum {
   SI_SEARCH_SENSOR              = 'S', // Search for sensor.
-  SI_DO_SINGLE_MEASUREMENT      = 'M', // Trigger single measurement and read it after 6 seconds.
+  SI_DO_SINGLE_MEASUREMENT      = 'M', // Trigger single measurement and read it as soon as it is complete.
   SI_SET_INSTRUCTION            = 'I', // Write Do-instruction to Tag (E.g. "I:0x04" for an reset or "I:0x06" to get config) //See also typedef "nt2s_do_instructions_t"
   SI_READ                       = 'R', // Read NFC-Tag data.
   SI_WRITE                      = 'W', // Write special data to NFC-Tag which is not handled via case 'I' (E.g. "W:Do:05;..." to set config.).
   SI_CONTINUOUS_MEASUREMENT     = 'C', // To enable or disable continuous measurement.
   SI_CHANGE_TIMING_4_CM         = 'T', // Change timing for continuous measurement in seconds (E.g. T:120).
+  SI_BINARY_OUTPUT              = 'B', // To enable or disable binary output frames (E.g. B:T).
+  SI_MEASUREMENT_LOG            = 'L', // Dump the measurement log ("L") or dump and clear it ("L:D").
+  SI_PROFILE                    = 'P', // Dump the timing counters ("P") or reset them ("P:R"). Build with -DTHMS_PROFILING.
+  SI_ERROR_COUNTERS             = 'E', // Dump the tag access error counters per PN532 status ("E") or reset them ("E:R").
+  SI_DEBUG_LEVEL                = 'D', // Print ("D") or set ("D:1F") the enabled debug info levels (bit mask, hex).
   SI_RESET                      = 'X'  // Reset and reboot.
 }serial_instruction_t;
 
+// cmdq_command_t.option of the on/off instructions (S, C, B)
+typedef enum {
+  SWITCH_TOGGLE                 = 0,  // "S"
+  SWITCH_ON                     = 1,  // "S:T"
+  SWITCH_OFF                    = 2   // "S:F"
+}switch_option_t;
+
+// Report of a serial instruction ("ACK:", "NAK:", "DONE:" lines / BFRAME_TYPE_COMMAND)
+typedef enum {
+  COMMAND_ACCEPTED              = 0x01, // Queued
+  COMMAND_REJECTED              = 0x02, // Not queued (syntax error or queue full)
+  COMMAND_DONE                  = 0x03  // Executed; error bits collected while it ran
+}command_report_t;
+
+typedef enum {
+  SEARCH_PENDING,               // Not found yet, next try is scheduled
+  SEARCH_FOUND,
+  SEARCH_FAILED                 // Not found after SENSOR_SEARCH_TRIES tries
+}sensor_search_result_t;
+
+// State of one sensor-tag (same index as in NFC_THMS_to_Serial)
+typedef struct sensor_state_t {
+  uint8_t uid[BFRAME_MAX_UID_LENGTH];
+  uint8_t uid_length;                       // 0: Entry unused
+  thms_message_t last_measurement;          // Last decoded measurement of this tag
+  bool last_measurement_valid;
+}sensor_state_t;
+
 /*------------ Global Variables ---------------*/
 static finite_state_machine_state_t fsm_state;
 static uint16_t error_no = ERROR_NO_ERROR;
@@ -83,31 +128,73 @@ static bool  continuous_measurement_m = DEFAULT_FOR_CONTINUOUS_MEASUREMENT;
 static uint16_t cont_meas_interval_in_s_m = DEFAULT_MEASUREMENT_INTERVAL_IN_S;
 static bool  sensor_available_m = false;
 static unsigned long next_measurement_time_s_m = 0;
-static uint8_t debug_level = (PRINT_DEBUG_INFO_ERROR*INFO_ERROR_INFO) 
-                           | (PRINT_DEBUG_INFO_STANDAR*INFO_STANDARD_INFO) 
-                           | (PRINT_DEBUG_INFO_FSM*INFO_FSM_STATE) 
-                           | (PRINT_NEXT_MEASUREMENT_INFO*INFO_NEXT_MEASUREMENT_INFO)
-                           | (PRINT_EXTENDED_INFO*INFO_EXTENDED_INFO);
-static char info_array_m[MAXIMAL_INFO_MESSAGE_LENGT];
 static uint8_t nfc_message_m[MAXIMAL_NDEF_MESSAGE_LENGT]; //Array for text message (NDEF)
 static uint8_t do_insturction_to_set_m;
 bool get_response_m; // To get response after do-instruction
+static retry_policy_t sensor_search_policy_m = RETRY_POLICY(SENSOR_SEARCH_TRIES, SENSOR_SEARCH_MIN_BACKOFF_MS, SENSOR_SEARCH_MAX_BACKOFF_MS, true);
+static retry_t sensor_search_retry_m;
+static sched_deadline_t sensor_search_deadline_m;   // Next try to find the sensor (running: search in progress)
+static sched_deadline_t response_deadline_m;        // Maximal time for the tag to process the Do-instruction
+static sched_deadline_t response_poll_deadline_m;   // Next poll of the "Do:"-field
+static sched_deadline_t tag_access_deadline_m;      // Next try of a tag access after a transient error (running: access interrupted)
+static line_buffer_t serial_input_m;                // Received serial bytes until a line is complete
+static bool binary_output_m = DEFAULT_FOR_BINARY_OUTPUT;
+static uint8_t frame_sequence_no_m = 0;
+static bool measurement_round_m = false;            // Measurement of all sensor-tags in progress
+static bool round_triggering_m = false;             // Round phase 1: Do:02 is sent to every sensor-tag in turn
+static uint8_t round_sensor_m = 0;                  // Sensor-tag triggered last in phase 1
+static uint8_t response_pending_m = 0;              // Bit i: sensor-tag i is triggered, answer not read yet
+static sensor_state_t sensor_state_m[NT2S_MAX_SENSORS];
+static cmdq_t command_queue_m;                      // Checked serial instructions, executed in order
+static cmdq_command_t running_command_m;
+static bool command_running_m = false;              // running_command_m waits for the FSM to become idle
+static uint16_t command_error_m = ERROR_NO_ERROR;   // error_no bits of the running command
 
 
 /*------------ Function Declaration ---------------*/
-void check_sensor_availability_5s(void); /* Search sensor for 5s (5 times) certain time*/
-void check_for_serial_instructions(void);  // Maximal length for instruction is 50. Each instruction has to end with '\n'.
-void parse_serial_4_instruction(char buf[], int rlen); 
+sensor_search_result_t check_sensor_availability(void); /* Search sensor (5 times, once per second) without blocking */
+bool tag_access_retry_pending(void);    // Backoff of an interrupted tag access is still running
+bool schedule_tag_access_retry(void);   // Transient error: repeat the FSM step after NT2S_retry_after_ms()
+bool check_for_serial_instructions(void);  // Maximal length for instruction is 50. Each instruction has to end with '\n'. Never blocks.
+void fsm_task(void);      // One step of the finite state machine
+void serial_task(void);   // Handling of serial instructions
+uint16_t parse_serial_4_instruction(char buf[], int rlen, cmdq_command_t * command);   // Error bits; ERROR_NO_ERROR: valid
+void execute_command(const cmdq_command_t * command);
+void run_commands(void);  // Completes the running command and starts the next ones while the FSM is idle
+bool fsm_busy(void);      // FSM works on a command or measurement round (sensor search does not count)
+void report_command(command_report_t report, uint8_t sequence_no, char code, uint16_t error);
 bool set_instruction(uint8_t do_instruction);
 bool set_instruction_to_do_measurement();
-void print_debug_info(uart_debug_info_t info_level);  // To print infos via USB-UART (Serial)
-void print_debug_info_f(const __FlashStringHelper * string_to_print, uart_debug_info_t info_level); //Print flash string (um RAM zu sparen)
+void send_info_frame(uint8_t level, const char text[], uint8_t length);   // Binary output of the debug infos (THMS_Log)
+void set_binary_output(bool binary_output);
 bool get_tag_data(uint8_t text_data_array[], uint8_t max_length);
+void print_tag_data(const char text[], const thms_message_t * message);   // Text line or binary frame (measurement/text)
+void send_frame(uint8_t type, const uint8_t payload[], uint8_t payload_length);
+void start_measurement_round(void);   // Measurement (Do:02) for all present sensor-tags
+finite_state_machine_state_t continue_measurement_round(void);  // Next state of the round (FSM_IDLE: complete)
+void remember_measurement(const thms_message_t * measurement);
+void dump_measurement_log(bool drain);   // All logged measurements in one burst (text lines or binary frames)
+void dump_error_counters(void);          // Failed tag accesses per DFRobot_PN532::eStatus_t
+#ifdef THMS_PROFILING
+void dump_profile(void);                 // Timing counters of all profiling points
+uint8_t fsm_profile_point(finite_state_machine_state_t state);
+#endif
+bool is_repeated_measurement(const thms_message_t * measurement);  // Same "No:" as the last measurement of the selected sensor-tag
+
+/*------------ Tasks ---------------*/
+#define TASK_FSM      0
+#define TASK_SERIAL   1
+static sched_task_t tasks_m[] = {
+  SCHED_TASK(fsm_task, FSM_SLOWDOWN),   // Runs immediately (triggered) as long as the FSM is not idle
+  SCHED_TASK(serial_task, 0)
+};
+#define NUMBER_OF_TASKS (sizeof(tasks_m)/sizeof(tasks_m[0]))
 
 
 void setup() {
   /* Initialisierung serielle Kommunikation*/
   Serial.begin(115200);   
+  sout.begin(&Serial);
   pinMode(LED_BUILTIN , OUTPUT);
   get_response_m = false;
 
@@ -118,14 +205,21 @@ void setup() {
     delay (100);
   }
   next_measurement_time_s_m = millis()/1000;
-  print_debug_info_f(F("NFC-THMS to Serial"),INFO_STANDARD_INFO);
-  memset(info_array_m,0,sizeof(info_array_m));
-  sprintf(info_array_m,"Debug level: 0x%x",debug_level);
-  print_debug_info(INFO_STANDARD_INFO);
+  line_buffer_init(&serial_input_m);
+  cmdq_init(&command_queue_m);
+  log_begin(&sout);
+  log_set_levels((PRINT_DEBUG_INFO_ERROR*LOG_ERROR) 
+               | (PRINT_DEBUG_INFO_STANDAR*LOG_STANDARD) 
+               | (PRINT_DEBUG_INFO_FSM*LOG_FSM_STATE) 
+               | (PRINT_NEXT_MEASUREMENT_INFO*LOG_NEXT_MEASUREMENT)
+               | (PRINT_EXTENDED_INFO*LOG_EXTENDED));
+  set_binary_output(binary_output_m);
+  LOG_MSG(LOG_STANDARD, "NFC-THMS to Serial");
+  LOG_MSG(LOG_STANDARD, "Debug level: 0x%x", log_levels());
 
   /* Initialisierung NFC-Gerät via I2C */        
   while (!init_NT2S()) {      
-    print_debug_info_f(F("Init failure"),INFO_ERROR_INFO);
+    LOG_MSG(LOG_ERROR, "Init failure");
     delay (1000);
   }
   sensor_available_m = false;
@@ -133,29 +227,28 @@ void setup() {
 }
 
 void loop() {
+  sched_run(tasks_m, NUMBER_OF_TASKS);
+}
+
+void fsm_task(void) {
+  PROF_SCOPE(fsm_profile_point(fsm_state));
   digitalWrite(LED_BUILTIN , HIGH); // To indicate some operation.
-  memset(info_array_m,0,sizeof(info_array_m));
-  sprintf(info_array_m,"FSM State: 0x%x",fsm_state);
-  print_debug_info(INFO_FSM_STATE);
+  LOG_MSG(LOG_FSM_STATE, "FSM State: 0x%x", fsm_state);
 
   /*>>> FINITE STATE MACHINE <<<*/
   switch(fsm_state){
     case FSM_IDLE: {
       if(continuous_measurement_m) {
         if ((millis()/1000) >= next_measurement_time_s_m) {
-          print_debug_info_f(F("Time to do auto measurement."),INFO_STANDARD_INFO);
-          do_insturction_to_set_m = NT2S_DO_SINGLE_MEASUREMENT;
-          fsm_state = FSM_WRITE_INSTRUCTION;
-          get_response_m = true;
+          LOG_MSG(LOG_STANDARD, "Time to do auto measurement.");
+          start_measurement_round();
           next_measurement_time_s_m = (millis()/1000) + cont_meas_interval_in_s_m;          
-        } else {
-          memset(info_array_m,0,sizeof(info_array_m));
+        } else if(LOG_ACTIVE(LOG_NEXT_MEASUREMENT)) {
           static unsigned int last_time_to_next_measurement = 0;
           unsigned int time_to_next_measurement = (next_measurement_time_s_m - (millis()/1000));
           if(last_time_to_next_measurement != time_to_next_measurement){
-            last_time_to_next_measurement = next_measurement_time_s_m - (millis()/1000);
-            sprintf(info_array_m,"Next meas. in [s]:%u",(unsigned int)(next_measurement_time_s_m - (millis()/1000)));
-            print_debug_info(INFO_NEXT_MEASUREMENT_INFO); 
+            last_time_to_next_measurement = time_to_next_measurement;
+            LOG_MSG(LOG_NEXT_MEASUREMENT, "Next meas. in [s]:%u", time_to_next_measurement);
           }
         }
       }
@@ -164,62 +257,105 @@ void loop() {
     //End case FSM_IDLE
 
     case FSM_SEARCH_SENSOR: {
-      check_sensor_availability_5s();
-      if(sensor_available_m) {
-        print_debug_info_f(F("Sensor found!"),INFO_STANDARD_INFO);
+      sensor_search_result_t search_result = check_sensor_availability();
+      if(search_result == SEARCH_FOUND) {
+        LOG_MSG(LOG_STANDARD, "Sensor found!");
         fsm_state = FSM_IDLE;
-      } else {
-        print_debug_info_f(F("No sensor found !!!"),INFO_STANDARD_INFO);
+      } else if(search_result == SEARCH_FAILED) {
+        LOG_MSG(LOG_STANDARD, "No sensor found !!!");
       }
       break;
     }
     //End case FSM_SEARCH_SENSOR
       
     case FSM_WRITE_INSTRUCTION: {
-      sprintf(info_array_m,"Write inst.: 0x%x",do_insturction_to_set_m);
-      print_debug_info(INFO_STANDARD_INFO);
+      if(!sensor_available_m && (check_sensor_availability() == SEARCH_PENDING)) break; // Try again in next step
+      if(tag_access_retry_pending()) break;
+      LOG_MSG(LOG_STANDARD, "Write inst.: 0x%x", do_insturction_to_set_m);
       bool instruction_is_set = false;  
-      if(!sensor_available_m) {check_sensor_availability_5s();}
       if(sensor_available_m) instruction_is_set = NT2S_set_instruction(do_insturction_to_set_m);
+      if(!instruction_is_set && schedule_tag_access_retry()) break;   // Same step again after the backoff
       if(instruction_is_set) {
-        print_debug_info_f(F("Instruction is sent to tag"),INFO_STANDARD_INFO);
+        LOG_MSG(LOG_STANDARD, "Instruction is sent to tag");
         fsm_state = FSM_IDLE;
       } else {
         error_no |= ERROR_SET_INSTRUCTION;
         fsm_state = FSM_ERROR;
       }
       if(get_response_m) {
+        get_response_m = false;
         if(instruction_is_set){
-          print_debug_info_f(F("Wait for response..."),INFO_STANDARD_INFO);
-          delay(2000);
-          if(do_insturction_to_set_m == NT2S_DO_SINGLE_MEASUREMENT) delay(3000);
-          fsm_state = FSM_READ_TAG_DATA;
+          response_pending_m |= (1 << NT2S_selected_sensor());
+          fsm_state = continue_measurement_round();   // Trigger the next sensor-tag or wait for the answers
         }
-        get_response_m = false;
       }
       break;
     }
     // End case FSM_WRITE_INSTRUCTION (0x03)
 
+    case FSM_WAIT_FOR_RESPONSE: {
+      // Response is complete as soon as the tag has replaced the written Do-instruction.
+      // All triggered sensor-tags measure at the same time; they are read in the order they complete.
+      bool response_complete = false;
+      if(sched_deadline_expired(&response_poll_deadline_m)) {
+        for(uint8_t i = 0; (i < NT2S_MAX_SENSORS) && !response_complete; i++) {
+          if(!(response_pending_m & (1 << i))) continue;
+          uint8_t do_instruction;
+          if(!NT2S_select_sensor(i)) {response_pending_m &= ~(1 << i); continue;} // Removed in the meantime
+          if(NT2S_read_do_instruction(&do_instruction) && (do_instruction != NT2S_DO_SINGLE_MEASUREMENT)) {
+            response_complete = true;
+          }
+        }
+        if(!response_complete) sched_deadline_start(&response_poll_deadline_m, RESPONSE_POLL_INTERVAL_MS); // Tags busy or not answering
+      }
+      if(!response_complete && (response_pending_m != 0) && sched_deadline_expired(&response_deadline_m)) {
+        LOG_MSG(LOG_EXTENDED, "No response in time. Read anyway.");
+        for(uint8_t i = 0; i < NT2S_MAX_SENSORS; i++) {
+          if((response_pending_m & (1 << i)) && NT2S_select_sensor(i)) {response_complete = true; break;}
+        }
+      }
+      if(response_complete) {
+        response_pending_m &= ~(1 << NT2S_selected_sensor());
+        fsm_state = FSM_READ_TAG_DATA;
+      } else if(response_pending_m == 0) {
+        fsm_state = continue_measurement_round();
+      }
+      break;
+    }
+    // End case FSM_WAIT_FOR_RESPONSE (0x07)
+
     case FSM_READ_TAG_DATA :{
+      if(!sensor_available_m && (check_sensor_availability() == SEARCH_PENDING)) break; // Try again in next step
+      if(tag_access_retry_pending()) break;
       bool data_reading_ok = false;
-      if(!sensor_available_m) {check_sensor_availability_5s();}
       if(sensor_available_m) data_reading_ok = NT2S_read_ndef_text(nfc_message_m, MAXIMAL_NDEF_MESSAGE_LENGT);
+      if(!data_reading_ok && schedule_tag_access_retry()) break;   // Same step again after the backoff
       if(data_reading_ok) {
-        print_debug_info_f(F("Read data:"),INFO_STANDARD_INFO);
-        sprintf(info_array_m,"%s",nfc_message_m);
-        Serial.println(info_array_m);
-        fsm_state = FSM_IDLE;
+        thms_message_t message;
+        bool message_ok = thms_message_parse((const char *)nfc_message_m, &message);
+        if(message_ok && thms_message_is_error(&message)) {
+          LOG_MSG(LOG_ERROR, "Tag error reply:");
+          print_tag_data((const char *)nfc_message_m, &message);
+          error_no |= ERROR_TAG_ERROR_REPLY;
+          fsm_state = FSM_ERROR;   // Continues the round
+          break;
+        }
+        if(measurement_round_m && message_ok && is_repeated_measurement(&message)) {
+          LOG_MSG(LOG_EXTENDED, "No new measurement (same No:)");   // e.g. read after timeout
+        } else {
+          LOG_MSG(LOG_STANDARD, "Read data:");
+          print_tag_data((const char *)nfc_message_m, message_ok ? &message : NULL);
+        }
+        fsm_state = continue_measurement_round();
       } else {error_no |= ERROR_GET_DATA; fsm_state = FSM_ERROR;}
       break;
     }
     //End case FSM_READ_TAG_DATA
 
     case FSM_ERROR: {
-      memset(info_array_m,0,sizeof(info_array_m));
-      sprintf(info_array_m,"ERROR No: 0x%x",error_no);
-      print_debug_info(INFO_ERROR_INFO);
-      fsm_state = FSM_IDLE;
+      LOG_MSG(LOG_ERROR, "ERROR No: 0x%x", error_no);
+      command_error_m |= error_no;
+      fsm_state = continue_measurement_round();  // Other sensor-tags of the round
       error_no = ERROR_NO_ERROR;
       break;
     }
@@ -233,149 +369,499 @@ void loop() {
     //End case default
   }
   digitalWrite(LED_BUILTIN , LOW); // For operation indication
-  if(!get_response_m)
-    delay(FSM_SLOWDOWN); 
+  if(fsm_state != FSM_IDLE) sched_task_trigger(&tasks_m[TASK_FSM]); // Pending work: no slowdown
+}
+
+void serial_task(void) {
   check_for_serial_instructions();
-  Serial.flush(); // Wait for serial communication to be finished.
+  run_commands();
 }
 
-void check_for_serial_instructions(void) {
-  const int buffer_size = 50;
-  char buf[buffer_size];
-  if (Serial.available() > 0) {
-    Serial.setTimeout(10000); //Give it 10s to complete Input
-    int rlen = Serial.readBytesUntil('\n', buf, buffer_size);
-    parse_serial_4_instruction(buf,rlen);
+/* Collect received bytes, check complete lines and queue them. Partial lines stay in the buffer until the rest arrives.
+   Every line is answered at once: "ACK:" (queued) or "NAK:" (rejected). */
+bool check_for_serial_instructions(void) {
+  char buf[MAXIMAL_SERIAL_INSTRUCTION_LENGT + 1];
+  bool instruction_received = false;
+  while (Serial.available() > 0) {
+    if (!line_buffer_put(&serial_input_m, (uint8_t)Serial.read())) break; // Full: rest stays in the Serial buffer
   }
+  for (uint8_t i = 0; i < SERIAL_INSTRUCTIONS_PER_PASS; i++) {
+    int rlen = line_buffer_get_line(&serial_input_m, buf, sizeof(buf));
+    if (rlen == LINE_BUFFER_NO_LINE) break;
+    if (rlen == 0) continue; // Empty line
+    instruction_received = true;
+    cmdq_command_t command;
+    command.sequence_no = cmdq_take_sequence_no(&command_queue_m);
+    if (rlen == LINE_BUFFER_LINE_TOO_LONG) {
+      LOG_MSG(LOG_ERROR, "Serial instruction too long!!");
+      report_command(COMMAND_REJECTED, command.sequence_no, '?', ERROR_SERIAL_INPUT);
+      continue;
+    }
+    LOG_MSG(LOG_STANDARD, "New serial instruction");
+    uint16_t error = parse_serial_4_instruction(buf, rlen, &command);
+    if ((error == ERROR_NO_ERROR) && !cmdq_push(&command_queue_m, &command)) error = ERROR_COMMAND_QUEUE_FULL;
+    report_command((error == ERROR_NO_ERROR) ? COMMAND_ACCEPTED : COMMAND_REJECTED, command.sequence_no, command.code, error);
+  }
+  return instruction_received;
+}
+
+/* Commands are executed between two FSM steps, one after the other. A command that only changes settings
+   or prints something is done at once; one that starts FSM work is done when the FSM is idle again. */
+void run_commands(void) {
+  for (uint8_t i = 0; i < SERIAL_INSTRUCTIONS_PER_PASS; i++) {
+    if (fsm_busy()) return;   // Also an automatic measurement round
+    if (command_running_m) {
+      command_running_m = false;
+      report_command(COMMAND_DONE, running_command_m.sequence_no, running_command_m.code, command_error_m);
+    }
+    if (!cmdq_pop(&command_queue_m, &running_command_m)) return;
+    command_error_m = ERROR_NO_ERROR;
+    command_running_m = true;
+    execute_command(&running_command_m);
+    if (fsm_state != FSM_IDLE) sched_task_trigger(&tasks_m[TASK_FSM]); // React without FSM slowdown
+  }
+}
+
+bool fsm_busy(void) {
+  return (fsm_state != FSM_IDLE) && (fsm_state != FSM_SEARCH_SENSOR);
+}
+
+/* Text: "ACK:<seq>;Cmd:<c>;Q:<waiting>;", "NAK:<seq>;Cmd:<c>;Err:<hex>;" or "DONE:<seq>;Cmd:<c>;Err:<hex>;".
+   Binary: one BFRAME_TYPE_COMMAND frame (report, seq, instruction letter, waiting commands, error bits uint16). */
+void report_command(command_report_t report, uint8_t sequence_no, char code, uint16_t error) {
+  uint8_t waiting = cmdq_count(&command_queue_m);
+  if(binary_output_m) {
+    uint8_t payload[BFRAME_COMMAND_LENGTH];
+    payload[0] = report;
+    payload[1] = sequence_no;
+    payload[2] = (uint8_t)code;
+    payload[3] = waiting;
+    payload[4] = (uint8_t)error;
+    payload[5] = (uint8_t)(error >> 8);
+    send_frame(BFRAME_TYPE_COMMAND, payload, sizeof(payload));
+    return;
+  }
+  if(report == COMMAND_ACCEPTED) fmt_print_key_udec(&sout, F("ACK"), sequence_no);
+  else if(report == COMMAND_REJECTED) fmt_print_key_udec(&sout, F("NAK"), sequence_no);
+  else fmt_print_key_udec(&sout, F("DONE"), sequence_no);
+  sout.print(F("Cmd:"));
+  sout.print(code);
+  sout.print(';');
+  if(report == COMMAND_ACCEPTED) fmt_print_key_udec(&sout, F("Q"), waiting);
+  else fmt_print_key_hex(&sout, F("Err"), error, 0);
+  sout.println();
+}
+
+/* Search sensor (SENSOR_SEARCH_TRIES times, backoff from THMS_Retry). Each call does at most one try and never waits.
+   Stops early if the PN532 reports an error that does not go away by trying again. */
+sensor_search_result_t check_sensor_availability(void) {
+  if(sched_deadline_running(&sensor_search_deadline_m) && !sched_deadline_expired(&sensor_search_deadline_m)) {
+    return SEARCH_PENDING;
+  }
+  if(!sched_deadline_running(&sensor_search_deadline_m)) {
+    LOG_MSG(LOG_EXTENDED, "Search sensor...");
+    retry_begin(&sensor_search_retry_m, &sensor_search_policy_m);
+  }
+  if(NT2S_search_sensor()) {
+    retry_succeeded(&sensor_search_retry_m);
+    sched_deadline_stop(&sensor_search_deadline_m);
+    sensor_available_m = true;
+    return SEARCH_FOUND;
+  }
+  if(!retry_failed(&sensor_search_retry_m, NT2S_last_status())) {
+    sched_deadline_stop(&sensor_search_deadline_m);
+    sensor_available_m = false;
+    error_no |= ERROR_SENSOR_CONNECTION_LOST;
+    LOG_MSG(LOG_STANDARD, "No sensor found!");
+    return SEARCH_FAILED;
+  }
+  sched_deadline_start(&sensor_search_deadline_m, sensor_search_retry_m.backoff_ms);
+  return SEARCH_PENDING;
 }
 
-/* Search sensor for 5s (5 times) certain time*/
-// ToDo: Exclude "sensor_available" -> only "sensor_available_m"
-void check_sensor_availability_5s(void) {
-  print_debug_info_f(F("Search sensor..."),INFO_EXTENDED_INFO);
-  uint8_t try_counter = 5;
-  while(!NT2S_search_sensor()) {
-    try_counter--;
-    delay(1000);
-    if(try_counter == 0) {
-      sensor_available_m = false;
-      error_no |= ERROR_SENSOR_CONNECTION_LOST;
-      print_debug_info_f(F("No sensor found!"),INFO_STANDARD_INFO);
-      return;
-    } 
-  } 
-  sensor_available_m = true;
-  return;
+/* Tag accesses never wait for a retry themselves (like the sensor search): serial_task and
+   the other tasks keep running during the backoff. Worst case per FSM step: one PN532 response timeout. */
+bool tag_access_retry_pending(void) {
+  if(!sched_deadline_running(&tag_access_deadline_m)) return false;
+  if(!sched_deadline_expired(&tag_access_deadline_m)) return true;
+  sched_deadline_stop(&tag_access_deadline_m);
+  return false;
 }
 
-void print_debug_info(uart_debug_info_t info_level) {
-  if(info_level & debug_level) {
-    Serial.print(">>> ");
-    Serial.println(info_array_m);
+bool schedule_tag_access_retry(void) {
+  uint16_t retry_after_ms = NT2S_retry_after_ms();
+  if(retry_after_ms == 0) return false;   // Succeeded, permanent error or no tries left
+  sched_deadline_start(&tag_access_deadline_m, retry_after_ms);
+  return true;
+}
+
+/* Binary info frame: level (1 byte) + text */
+void send_info_frame(uint8_t level, const char text[], uint8_t length) {
+  uint8_t payload[BFRAME_MAX_PAYLOAD];
+  payload[0] = level;
+  memcpy(&payload[1], text, length);
+  send_frame(BFRAME_TYPE_INFO, payload, 1 + length);
+}
+
+void set_binary_output(bool binary_output) {
+  binary_output_m = binary_output;
+  NT2S_set_debug_output(!binary_output_m);
+  log_set_frame_output(binary_output_m ? send_info_frame : NULL);
+}
+
+/* message: Parsed text (NULL if it has no "key:value;" format) */
+void print_tag_data(const char text[], const thms_message_t * message) {
+  bool is_measurement = (message != NULL) && thms_message_is_measurement(message);
+  if(is_measurement) remember_measurement(message);
+  if(!binary_output_m) {
+    if(PRINT_UID_WITH_TAG_DATA) {
+      uint8_t uid[BFRAME_MAX_UID_LENGTH];
+      uint8_t uid_length = NT2S_get_uid(uid);
+      sout.print(F("UID:"));
+      fmt_print_hex_bytes(&sout, uid, uid_length);
+      sout.print(';');
+    }
+    sout.println(text);
+    return;
+  }
+  if(is_measurement) {
+    uint8_t payload[BFRAME_MEASUREMENT_LENGTH];
+    send_frame(BFRAME_TYPE_MEASUREMENT, payload, bframe_put_measurement(payload, message));
+  } else {
+    send_frame(BFRAME_TYPE_TEXT, (const uint8_t *)text, strnlen(text, BFRAME_MAX_PAYLOAD));
   }
 }
 
-void print_debug_info_f(const __FlashStringHelper * string_to_print,uart_debug_info_t info_level) {
-  if(info_level & debug_level) {
-    Serial.print(F(">>> "));
-    Serial.println(string_to_print);
+/* Last measurement per sensor-tag. The entry is reset when another UID got the index. */
+void remember_measurement(const thms_message_t * measurement) {
+  sensor_state_t * state = &sensor_state_m[NT2S_selected_sensor()];
+  uint8_t uid[BFRAME_MAX_UID_LENGTH];
+  uint8_t uid_length = NT2S_get_uid(uid);
+  if((state->uid_length != uid_length) || (memcmp(state->uid, uid, uid_length) != 0)) {
+    memcpy(state->uid, uid, uid_length);
+    state->uid_length = uid_length;
   }
+  state->last_measurement = *measurement;
+  state->last_measurement_valid = true;
+  mlog_add(millis(), uid, uid_length, measurement);
 }
 
-void parse_serial_4_instruction(char buf[], int rlen) {
-  //ToDo: Parse for instruction or change config etc
-  print_debug_info_f(F("New serial instruction"),INFO_STANDARD_INFO);
-  switch(buf[0]) {
-    case SI_SEARCH_SENSOR: 
-    case (SI_SEARCH_SENSOR|0x20):{ //Lower case
+bool is_repeated_measurement(const thms_message_t * measurement) {
+  if(!thms_message_is_measurement(measurement)) return false;
+  const sensor_state_t * state = &sensor_state_m[NT2S_selected_sensor()];
+  uint8_t uid[BFRAME_MAX_UID_LENGTH];
+  uint8_t uid_length = NT2S_get_uid(uid);
+  return state->last_measurement_valid && (state->uid_length == uid_length)
+      && (memcmp(state->uid, uid, uid_length) == 0) && (state->last_measurement.no == measurement->no);
+}
+
+/* Sensor-tags are searched again at the start of every round, so added tags are measured from the next round on.
+   Phase 1 sends Do:02 to every present sensor-tag, phase 2 reads the answers as they complete:
+   the round takes about one measurement time instead of one per sensor-tag. */
+void start_measurement_round(void) {
+  sensor_available_m = (NT2S_search_sensors() > 0);   // Otherwise FSM_WRITE_INSTRUCTION searches (with retries)
+  measurement_round_m = true;
+  round_triggering_m = true;
+  response_pending_m = 0;
+  round_sensor_m = NT2S_selected_sensor();
+  for(uint8_t i = 0; sensor_available_m && (i < NT2S_MAX_SENSORS); i++) {
+    if(NT2S_select_sensor(i)) { round_sensor_m = i; break; }   // Start with the first present sensor-tag
+  }
+  do_insturction_to_set_m = NT2S_DO_SINGLE_MEASUREMENT;
+  get_response_m = true;
+  fsm_state = FSM_WRITE_INSTRUCTION;
+}
+
+finite_state_machine_state_t continue_measurement_round(void) {
+  if(!measurement_round_m) return FSM_IDLE;
+  if(round_triggering_m) {
+    for(uint8_t i = round_sensor_m + 1; i < NT2S_MAX_SENSORS; i++) {
+      if(NT2S_select_sensor(i)) {
+        round_sensor_m = i;
+        do_insturction_to_set_m = NT2S_DO_SINGLE_MEASUREMENT;
+        get_response_m = true;
+        return FSM_WRITE_INSTRUCTION;
+      }
+    }
+    round_triggering_m = false;   // All sensor-tags triggered: wait for the answers
+    if(response_pending_m != 0) {
+      LOG_MSG(LOG_STANDARD, "Wait for response...");
+      sched_deadline_start(&response_deadline_m, RESPONSE_TIMEOUT_MS);
+      sched_deadline_start(&response_poll_deadline_m, RESPONSE_FIRST_POLL_MS);
+    }
+  }
+  if(response_pending_m != 0) return FSM_WAIT_FOR_RESPONSE;
+  sched_deadline_stop(&response_deadline_m);
+  sched_deadline_stop(&response_poll_deadline_m);
+  measurement_round_m = false;
+  return FSM_IDLE;
+}
+
+/* Text: "Log:<count>;Dropped:<count>;" followed by one line "T:<ms>;UH:<hash>;No:..;SS:..;MS:..;RSQPB:..;" per record.
+   Binary: one BFRAME_TYPE_LOG_RECORD frame per record and one with empty payload at the end. */
+void dump_measurement_log(bool drain) {
+  uint16_t count = mlog_count();
+  if(!binary_output_m) {
+    fmt_print_key_udec(&sout, F("Log"), count);
+    fmt_print_key_udec(&sout, F("Dropped"), mlog_dropped());
+    sout.println();
+  }
+  for(uint16_t i = 0; i < count; i++) {
+    mlog_record_t record;
+    if(!mlog_get(i, &record)) break;
+    if(binary_output_m) {
+      uint8_t frame[BFRAME_MAX_FRAME_LENGTH];
+      uint8_t payload[MLOG_RECORD_LENGTH];
+      uint8_t payload_length = bframe_put_log_record(payload, &record);
+      sout.write(frame, bframe_build(frame, BFRAME_TYPE_LOG_RECORD, frame_sequence_no_m++, millis(), NULL, 0, payload, payload_length));
+      continue;
+    }
+    fmt_print_key_udec(&sout, F("T"), record.time_ms);
+    fmt_print_key_hex(&sout, F("UH"), record.uid_hash, 4);
+    fmt_print_key_udec(&sout, F("No"), record.no);
+    fmt_print_key_udec(&sout, F("SS"), record.ss);
+    fmt_print_key_udec(&sout, F("MS"), record.ms);
+    fmt_print_key_udec(&sout, F("RSQPB"), record.rsqpb);
+    sout.println();
+  }
+  if(binary_output_m) {
+    uint8_t frame[BFRAME_MAX_FRAME_LENGTH];
+    sout.write(frame, bframe_build(frame, BFRAME_TYPE_LOG_RECORD, frame_sequence_no_m++, millis(), NULL, 0, NULL, 0));
+  }
+  if(drain) mlog_clear();
+}
+
+/* Text: one line "E:<status>;N:<count>;" per error status, then the serial output counters
+   "E:TX high water;N:<bytes>;" and "E:TX full;N:<count>;".
+   Binary: one BFRAME_TYPE_ERROR_COUNTERS frame with the counts (uint16 each, status 1..STATUS_COUNT-1,
+   high water, full). */
+void dump_error_counters(void) {
+  if(binary_output_m) {
+    uint8_t payload[2*(DFRobot_PN532::STATUS_COUNT - 1) + 4];
+    uint8_t n = 0;
+    for(uint8_t status = 1; status < DFRobot_PN532::STATUS_COUNT; status++) {
+      uint16_t count = retry_error_count((retry_status_t)status);
+      payload[n++] = (uint8_t)count;
+      payload[n++] = (uint8_t)(count >> 8);
+    }
+    uint16_t high_water = sout_high_water();
+    uint16_t stalls = sout_stalls();
+    payload[n++] = (uint8_t)high_water;
+    payload[n++] = (uint8_t)(high_water >> 8);
+    payload[n++] = (uint8_t)stalls;
+    payload[n++] = (uint8_t)(stalls >> 8);
+    send_frame(BFRAME_TYPE_ERROR_COUNTERS, payload, n);
+    return;
+  }
+  for(uint8_t status = 1; status < DFRobot_PN532::STATUS_COUNT; status++) {
+    sout.print(F("E:"));
+    sout.print(DFRobot_PN532::statusName((retry_status_t)status));
+    sout.print(';');
+    fmt_print_key_udec(&sout, F("N"), retry_error_count((retry_status_t)status));
+    sout.println();
+  }
+  sout.print(F("E:TX high water;"));
+  fmt_print_key_udec(&sout, F("N"), sout_high_water());
+  sout.println();
+  sout.print(F("E:TX full;"));
+  fmt_print_key_udec(&sout, F("N"), sout_stalls());
+  sout.println();
+}
+
+#ifdef THMS_PROFILING
+/* Text: one line "P:<name>;N:<count>;T:<total us>;Max:<max us>;R:<retries>;" per profiling point.
+   Binary: one BFRAME_TYPE_PROFILE frame per profiling point. */
+void dump_profile(void) {
+  for(uint8_t point = 0; point < NUMBER_OF_PROF_POINTS; point++) {
+    const prof_counter_t * counter = prof_get(point);
+    if(binary_output_m) {
+      uint8_t payload[BFRAME_PROFILE_LENGTH];
+      send_frame(BFRAME_TYPE_PROFILE, payload, bframe_put_profile_counter(payload, point, counter));
+      continue;
+    }
+    sout.print(F("P:"));
+    sout.print(prof_name(point));
+    sout.print(';');
+    fmt_print_key_udec(&sout, F("N"), counter->count);
+    fmt_print_key_udec(&sout, F("T"), counter->total_us);
+    fmt_print_key_udec(&sout, F("Max"), counter->max_us);
+    fmt_print_key_udec(&sout, F("R"), counter->retries);
+    sout.println();
+  }
+}
+
+uint8_t fsm_profile_point(finite_state_machine_state_t state) {
+  switch(state) {
+    case FSM_IDLE: return PROF_FSM_IDLE;
+    case FSM_SEARCH_SENSOR: return PROF_FSM_SEARCH_SENSOR;
+    case FSM_WRITE_INSTRUCTION: return PROF_FSM_WRITE_INSTRUCTION;
+    case FSM_WAIT_FOR_RESPONSE: return PROF_FSM_WAIT_FOR_RESPONSE;
+    case FSM_READ_TAG_DATA: return PROF_FSM_READ_TAG_DATA;
+    default: return PROF_FSM_ERROR;
+  }
+}
+#endif
+
+void send_frame(uint8_t type, const uint8_t payload[], uint8_t payload_length) {
+  uint8_t frame[BFRAME_MAX_FRAME_LENGTH];
+  uint8_t uid[BFRAME_MAX_UID_LENGTH];
+  uint8_t uid_length = NT2S_get_uid(uid);
+  uint8_t frame_length = bframe_build(frame, type, frame_sequence_no_m++, millis(), uid, uid_length, payload, payload_length);
+  sout.write(frame, frame_length);
+}
+
+/* Checks one serial instruction and stores it as compact command. Nothing is executed here.
+   Returns the error bits (ERROR_NO_ERROR: command is valid). */
+uint16_t parse_serial_4_instruction(char buf[], int rlen, cmdq_command_t * command) {
+  command->code = toupper(buf[0]);   // Only letters change; unknown codes are reported as sent
+  command->option = 0;
+  command->value = 0;
+  bool has_argument = (rlen >= 3) && (buf[1] == ':');
+  switch(command->code) {
+    case SI_SEARCH_SENSOR:
+    case SI_CONTINUOUS_MEASUREMENT:
+    case SI_BINARY_OUTPUT: {
       if(rlen <= 2) {
-        fsm_state = (fsm_state == FSM_SEARCH_SENSOR)?FSM_IDLE:FSM_SEARCH_SENSOR; // Toggle state
-      } else if((rlen >= 3) && (buf[1] == ':')) {
-        fsm_state = ((buf[2]=='T')||(buf[2]=='t'))?FSM_SEARCH_SENSOR:FSM_IDLE;
+        command->option = SWITCH_TOGGLE;
+      } else if(has_argument) {
+        command->option = ((buf[2]=='T')||(buf[2]=='t'))?SWITCH_ON:SWITCH_OFF;
       } else {
-        fsm_state = FSM_ERROR;
-        error_no |= ERROR_SERIAL_INPUT;
-        break;
+        return ERROR_SERIAL_INPUT;
+      }
+      return ERROR_NO_ERROR;
+    }
+    case SI_SET_INSTRUCTION: {
+      //E.g. buf = "I:0x06" -> get config
+      uint32_t new_instruction;
+      if(!has_argument || (fmt_parse_uint(&buf[2], 16, 0xFF, &new_instruction, NULL) != FMT_OK)
+         || (new_instruction == NT2S_ERROR)) return ERROR_SERIAL_INPUT;
+      command->value = new_instruction;
+      return ERROR_NO_ERROR;
+    }
+    case SI_CHANGE_TIMING_4_CM: {
+      uint32_t parsed_interval;
+      if(!has_argument || (fmt_parse_uint(&buf[2], 10, 0xFFFF, &parsed_interval, NULL) != FMT_OK)) return ERROR_SERIAL_INPUT;
+      command->value = parsed_interval;
+      return ERROR_NO_ERROR;
+    }
+    case SI_MEASUREMENT_LOG:
+    case SI_PROFILE:
+    case SI_ERROR_COUNTERS: {
+      char expected = (command->code == SI_MEASUREMENT_LOG) ? 'D' : 'R';   // "L:D" drain, "P:R"/"E:R" reset
+      if(has_argument && (toupper(buf[2]) == expected)) command->option = 1;
+      else if(rlen >= 3) return ERROR_SERIAL_INPUT;
+#ifndef THMS_PROFILING
+      if(command->code == SI_PROFILE) {
+        LOG_MSG(LOG_ERROR, "Profiling not compiled in (THMS_PROFILING).");
+        return ERROR_SERIAL_INPUT;
+      }
+#endif
+      return ERROR_NO_ERROR;
+    }
+    case SI_DEBUG_LEVEL: {
+      if(has_argument) {
+        uint32_t levels;
+        if(fmt_parse_uint(&buf[2], 16, 0xFF, &levels, NULL) != FMT_OK) return ERROR_SERIAL_INPUT;
+        command->option = 1;
+        command->value = levels;
+      } else if(rlen >= 3) {
+        return ERROR_SERIAL_INPUT;
       }
-      print_debug_info_f(
-        (fsm_state == FSM_SEARCH_SENSOR)?F("Inst.: START to search sensor."):F("Inst.: STOP to search sensor.")
-        ,INFO_STANDARD_INFO);
+      return ERROR_NO_ERROR;
+    }
+    case SI_DO_SINGLE_MEASUREMENT:
+    case SI_READ:
+    case SI_WRITE:
+    case SI_RESET:
+      return ERROR_NO_ERROR;
+    default:
+      LOG_MSG(LOG_ERROR, "Unknown serial instruction!!");
+      return ERROR_SERIAL_INPUT;
+  }
+}
+
+/* Runs a queued command. Commands that need the FSM only set its state; they complete when the FSM is idle again. */
+void execute_command(const cmdq_command_t * command) {
+  switch(command->code) {
+    case SI_SEARCH_SENSOR: {
+      bool search = (command->option == SWITCH_TOGGLE) ? (fsm_state != FSM_SEARCH_SENSOR) : (command->option == SWITCH_ON);
+      fsm_state = search ? FSM_SEARCH_SENSOR : FSM_IDLE;
+      if(search) LOG_MSG(LOG_STANDARD, "Inst.: START to search sensor.");
+      else LOG_MSG(LOG_STANDARD, "Inst.: STOP to search sensor.");
       break;}
-    case SI_DO_SINGLE_MEASUREMENT: 
-    case (SI_DO_SINGLE_MEASUREMENT|0x20):{ //Lower case
-      print_debug_info_f(F("Instruction to do single measurement."),INFO_STANDARD_INFO);
-      do_insturction_to_set_m = NT2S_DO_SINGLE_MEASUREMENT;
-      fsm_state = FSM_WRITE_INSTRUCTION;
-      get_response_m = true;
+    case SI_DO_SINGLE_MEASUREMENT: {
+      LOG_MSG(LOG_STANDARD, "Instruction to do single measurement.");
+      start_measurement_round();
       break;}
-    case SI_SET_INSTRUCTION: 
-    case (SI_SET_INSTRUCTION|0x20): {//Lower case
-      print_debug_info_f(F("Inst.: Send Do-Inst. to Tag."),INFO_STANDARD_INFO); 
-      //E.g. buf = "I:0x06" -> get config
-      unsigned int new_instruction;
-      sscanf(buf,"I:%x", &new_instruction);
-      do_insturction_to_set_m = (uint8_t) new_instruction;
-      memset(info_array_m,0,sizeof(info_array_m));
-      sprintf(info_array_m,"New inst.: %x",do_insturction_to_set_m);
-      print_debug_info(INFO_STANDARD_INFO);  
-      fsm_state = (new_instruction != NT2S_ERROR)?FSM_WRITE_INSTRUCTION:FSM_ERROR;
-      // ToDo: Parse instruction
+    case SI_SET_INSTRUCTION: {
+      LOG_MSG(LOG_STANDARD, "Inst.: Send Do-Inst. to Tag."); 
+      do_insturction_to_set_m = (uint8_t) command->value;
+      LOG_MSG(LOG_STANDARD, "New inst.: %x", do_insturction_to_set_m);
+      fsm_state = FSM_WRITE_INSTRUCTION;
       break;}
-    case SI_READ: 
-    case (SI_READ|0x20):{ //Lower case
-      print_debug_info_f(F("Inst.: Read tag data."),INFO_STANDARD_INFO); 
+    case SI_READ: {
+      LOG_MSG(LOG_STANDARD, "Inst.: Read tag data."); 
       fsm_state = FSM_READ_TAG_DATA;
       break;}
-    case SI_WRITE: 
-    case (SI_WRITE|0x20):{ //Lower case
-      print_debug_info_f(F("Inst.: Do write data to tag."),INFO_STANDARD_INFO); 
+    case SI_WRITE: {
+      LOG_MSG(LOG_STANDARD, "Inst.: Do write data to tag."); 
       fsm_state = FSM_WRITE_DATA;
       // ToDo: Parse write data
       break;}
-    case SI_CONTINUOUS_MEASUREMENT:
-    case (SI_CONTINUOUS_MEASUREMENT|0x20): {//Lower case 
-      if(rlen <= 2) {
-        continuous_measurement_m = !continuous_measurement_m;//toggle
-      } else if((rlen >= 3) && (buf[1] == ':')) {
-        continuous_measurement_m = ((buf[2]=='T')||(buf[2]=='t'))?true:false;
+    case SI_CONTINUOUS_MEASUREMENT: {
+      continuous_measurement_m = (command->option == SWITCH_TOGGLE) ? !continuous_measurement_m : (command->option == SWITCH_ON);
+      if(continuous_measurement_m) next_measurement_time_s_m = 0;
+      if(continuous_measurement_m) LOG_MSG(LOG_STANDARD, "Inst.: START continuous measurement.");
+      else LOG_MSG(LOG_STANDARD, "Inst.: STOP continuous measurement.");
+      break;
+    }
+    case SI_CHANGE_TIMING_4_CM: {
+      LOG_MSG(LOG_STANDARD, "Inst.: Change timing for continuous measurement"); 
+      cont_meas_interval_in_s_m = command->value;
+      LOG_MSG(LOG_STANDARD, "New interval for continuous measurement: %u", cont_meas_interval_in_s_m);
+      break;
+    }
+    case SI_BINARY_OUTPUT: {
+      set_binary_output((command->option == SWITCH_TOGGLE) ? !binary_output_m : (command->option == SWITCH_ON));
+      if(binary_output_m) LOG_MSG(LOG_STANDARD, "Inst.: START binary output.");
+      else LOG_MSG(LOG_STANDARD, "Inst.: STOP binary output.");
+      break;
+    }
+    case SI_MEASUREMENT_LOG: {
+      dump_measurement_log(command->option != 0);
+      break;
+    }
+    case SI_PROFILE: {
+#ifdef THMS_PROFILING
+      if(command->option != 0) {
+        prof_reset();
+        LOG_MSG(LOG_STANDARD, "Inst.: Profiling counters reset.");
       } else {
-        fsm_state = FSM_ERROR;
-        error_no |= ERROR_SERIAL_INPUT;
-        break;
+        dump_profile();
       }
-      if(continuous_measurement_m) next_measurement_time_s_m = 0;
-      print_debug_info_f(
-        (continuous_measurement_m)?F("Inst.: START continuous measurement."):F("Inst.: STOP continuous measurement.")
-        ,INFO_STANDARD_INFO);
+#endif
       break;
     }
-    case SI_CHANGE_TIMING_4_CM:
-    case (SI_CHANGE_TIMING_4_CM|0x20): {//Lower case 
-      print_debug_info_f(F("Inst.: Change timing for continuous measurement"),INFO_STANDARD_INFO); 
-      if(rlen >= 3) {
-        uint16_t parsed_interval;
-        int t = sscanf(&buf[1],":%u",&parsed_interval);
-        if(t == 1) {
-          cont_meas_interval_in_s_m = parsed_interval;
-          memset(info_array_m,0,sizeof(info_array_m));
-          sprintf(info_array_m,"New interval for continuous measurement: %u",parsed_interval);
-          print_debug_info(INFO_STANDARD_INFO);
-          break;
-        } 
-      } 
-      fsm_state = FSM_ERROR;
-      error_no |= ERROR_SERIAL_INPUT;
+    case SI_ERROR_COUNTERS: {
+      if(command->option != 0) {
+        retry_reset_counters();
+        sout_reset_counters();
+        LOG_MSG(LOG_STANDARD, "Inst.: Error counters reset.");
+      } else {
+        dump_error_counters();
+      }
       break;
     }
-    case SI_RESET:
-    case (SI_RESET|0x20): { //Lower case
+    case SI_DEBUG_LEVEL: {
+      if(command->option != 0) log_set_levels((uint8_t)command->value);
+      LOG_MSG(LOG_STANDARD, "Debug level: 0x%x", log_levels());
+      break;
+    }
+    case SI_RESET: {
       //softwareReset::standard();
       break;
     }
-    default:{
-      print_debug_info_f(F("Unknown serial instruction!!"),INFO_ERROR_INFO); 
-      fsm_state = FSM_ERROR;
-      error_no |= ERROR_SERIAL_INPUT;
-      break;}
+    default:
+      break;
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,167 @@
+/**************************************************************************/
+/*!
+ *   @file: test_main.cpp (test_binary_frame)
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Binäres Ausgabeformat aus THMS_Binary_Frame: CRC16 (CCITT-FALSE),
+ *             COBS-Kodierung (Null-Folgen, volle Blöcke) und ein kompletter
+ *             Frame, der dekodiert und Feld für Feld geprüft wird.
+ *             Aufruf: pio test -e native -f test_binary_frame
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <unity.h>
+#include <THMS_Binary_Frame.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Functions */
+/* COBS decoding of a frame without delimiter (0: invalid encoding) */
+static uint8_t cobs_decode(const uint8_t src[], uint8_t length, uint8_t dst[]) {
+  uint8_t in = 0;
+  uint8_t out = 0;
+  while (in < length) {
+    uint8_t code = src[in++];
+    if ((code == 0x00) || (in + code - 1 > length)) return 0;
+    for (uint8_t i = 1; i < code; i++) {
+      if (src[in] == 0x00) return 0;
+      dst[out++] = src[in++];
+    }
+    if ((code < 0xFF) && (in < length)) dst[out++] = 0x00;
+  }
+  return out;
+}
+
+static uint8_t check_cobs(const uint8_t src[], uint8_t length, const uint8_t expected[], uint8_t expected_length) {
+  uint8_t encoded[256];
+  uint8_t encoded_length = bframe_cobs_encode(src, length, encoded);
+  TEST_ASSERT_EQUAL_UINT8(expected_length, encoded_length);
+  TEST_ASSERT_EQUAL_MEMORY(expected, encoded, expected_length);
+  return encoded_length;
+}
+/* >> END: Internal Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Tests */
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_crc16_check_value(void) {
+  const uint8_t text[] = "123456789";
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, bframe_crc16(text, 9, 0xFFFF));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, bframe_crc16(text, 0, 0xFFFF));
+}
+
+/* The CRC can be continued over several parts */
+void test_crc16_in_parts(void) {
+  const uint8_t text[] = "123456789";
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, bframe_crc16(&text[4], 5, bframe_crc16(text, 4, 0xFFFF)));
+}
+
+void test_cobs_without_zeros(void) {
+  static const uint8_t data[] = {0x11, 0x22, 0x33, 0x44};
+  static const uint8_t expected[] = {0x05, 0x11, 0x22, 0x33, 0x44};
+  check_cobs(data, sizeof(data), expected, sizeof(expected));
+  static const uint8_t empty_expected[] = {0x01};
+  check_cobs(data, 0, empty_expected, sizeof(empty_expected));
+}
+
+void test_cobs_zero_runs(void) {
+  static const uint8_t one_zero[] = {0x00};
+  static const uint8_t one_zero_expected[] = {0x01, 0x01};
+  check_cobs(one_zero, sizeof(one_zero), one_zero_expected, sizeof(one_zero_expected));
+  static const uint8_t zeros[] = {0x00, 0x00, 0x00};
+  static const uint8_t zeros_expected[] = {0x01, 0x01, 0x01, 0x01};
+  check_cobs(zeros, sizeof(zeros), zeros_expected, sizeof(zeros_expected));
+  static const uint8_t mixed[] = {0x11, 0x22, 0x00, 0x33, 0x00, 0x00};
+  static const uint8_t mixed_expected[] = {0x03, 0x11, 0x22, 0x02, 0x33, 0x01, 0x01};
+  check_cobs(mixed, sizeof(mixed), mixed_expected, sizeof(mixed_expected));
+}
+
+/* 253 bytes without zero: the largest input whose encoded length fits into uint8_t */
+void test_cobs_longest_block(void) {
+  uint8_t data[253];
+  uint8_t expected[254];
+  for (uint16_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i + 1);
+  expected[0] = 0xFE;
+  memcpy(&expected[1], data, sizeof(data));
+  check_cobs(data, sizeof(data), expected, sizeof(expected));
+}
+
+/* Frame of a measurement: no 0x00 before the delimiter, fields and CRC after decoding */
+void test_measurement_frame_round_trip(void) {
+  static const uint8_t uid[] = {0x04, 0x5A, 0x1B, 0x92, 0x3C, 0x6E, 0x80};
+  thms_message_t measurement;
+  memset(&measurement, 0, sizeof(measurement));
+  measurement.do_instruction = 0x01;
+  measurement.no = 256;   // Low byte 0x00
+  measurement.ss = 123;
+  measurement.ms = 456;
+  measurement.rsqpb = 1203;
+  uint8_t payload[BFRAME_MEASUREMENT_LENGTH];
+  TEST_ASSERT_EQUAL_UINT8(BFRAME_MEASUREMENT_LENGTH, bframe_put_measurement(payload, &measurement));
+
+  uint8_t frame[BFRAME_MAX_FRAME_LENGTH];
+  uint8_t length = bframe_build(frame, BFRAME_TYPE_MEASUREMENT, 0x42, 0x00012300UL,
+                                uid, sizeof(uid), payload, sizeof(payload));
+  TEST_ASSERT_TRUE(length <= BFRAME_MAX_FRAME_LENGTH);
+  TEST_ASSERT_EQUAL_HEX8(BFRAME_DELIMITER, frame[length - 1]);
+  TEST_ASSERT_NULL(memchr(frame, 0x00, length - 1));
+
+  uint8_t raw[BFRAME_MAX_RAW_LENGTH];
+  uint8_t raw_length = cobs_decode(frame, length - 1, raw);
+  TEST_ASSERT_EQUAL_UINT8(BFRAME_HEADER_LENGTH + sizeof(uid) + BFRAME_MEASUREMENT_LENGTH + 2, raw_length);
+  static const uint8_t header[] = {BFRAME_TYPE_MEASUREMENT, 0x42, 0x00, 0x23, 0x01, 0x00, 7};
+  TEST_ASSERT_EQUAL_MEMORY(header, raw, sizeof(header));
+  TEST_ASSERT_EQUAL_MEMORY(uid, &raw[BFRAME_HEADER_LENGTH], sizeof(uid));
+  static const uint8_t measurement_bytes[] = {0x01, 0x00, 0x01, 0x7B, 0x00, 0xC8, 0x01, 0xB3, 0x04};
+  TEST_ASSERT_EQUAL_MEMORY(measurement_bytes, &raw[BFRAME_HEADER_LENGTH + sizeof(uid)], sizeof(measurement_bytes));
+  uint16_t crc = bframe_crc16(raw, raw_length - 2, 0xFFFF);
+  TEST_ASSERT_EQUAL_HEX8((uint8_t)crc, raw[raw_length - 2]);
+  TEST_ASSERT_EQUAL_HEX8((uint8_t)(crc >> 8), raw[raw_length - 1]);
+}
+
+/* Too long UID and payload are truncated, the frame still fits into BFRAME_MAX_FRAME_LENGTH */
+void test_frame_truncates_to_maximum(void) {
+  uint8_t uid[10];
+  uint8_t payload[BFRAME_MAX_PAYLOAD + 20];
+  memset(uid, 0xA5, sizeof(uid));
+  memset(payload, 0x00, sizeof(payload));   // Worst case for COBS
+  uint8_t frame[BFRAME_MAX_FRAME_LENGTH];
+  uint8_t length = bframe_build(frame, BFRAME_TYPE_TEXT, 0, 0, uid, sizeof(uid), payload, sizeof(payload));
+  TEST_ASSERT_EQUAL_UINT8(BFRAME_MAX_FRAME_LENGTH, length);
+  uint8_t raw[BFRAME_MAX_RAW_LENGTH];
+  TEST_ASSERT_EQUAL_UINT8(BFRAME_MAX_RAW_LENGTH, cobs_decode(frame, length - 1, raw));
+  TEST_ASSERT_EQUAL_UINT8(BFRAME_MAX_UID_LENGTH, raw[BFRAME_HEADER_LENGTH - 1]);
+}
+
+/* Frame without UID and payload */
+void test_empty_frame(void) {
+  uint8_t frame[BFRAME_MAX_FRAME_LENGTH];
+  uint8_t length = bframe_build(frame, BFRAME_TYPE_LOG_RECORD, 7, 1000, NULL, 0, NULL, 0);
+  uint8_t raw[BFRAME_MAX_RAW_LENGTH];
+  TEST_ASSERT_EQUAL_UINT8(BFRAME_HEADER_LENGTH + 2, cobs_decode(frame, length - 1, raw));
+  TEST_ASSERT_EQUAL_HEX8(BFRAME_TYPE_LOG_RECORD, raw[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, raw[BFRAME_HEADER_LENGTH - 1]);
+}
+/* >> END: Tests */
+
+
+int main(int argc, char ** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_crc16_in_parts);
+  RUN_TEST(test_cobs_without_zeros);
+  RUN_TEST(test_cobs_zero_runs);
+  RUN_TEST(test_cobs_longest_block);
+  RUN_TEST(test_measurement_frame_round_trip);
+  RUN_TEST(test_frame_truncates_to_maximum);
+  RUN_TEST(test_empty_frame);
+  return UNITY_END();
+}
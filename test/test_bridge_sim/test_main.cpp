@@ -0,0 +1,130 @@
+/**************************************************************************/
+/*!
+ *   @file: test_main.cpp (test_bridge_sim)
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Bridge-Firmware (setup()/loop()) mit simuliertem PN532 und
+ *             Sensor-Tag: Befehlsfolge C:F, M und ein unbekannter Befehl,
+ *             geprüft werden Quittungen (ACK/DONE/NAK) und Messwertzeilen.
+ *             Aufruf: pio test -e native -f test_bridge_sim
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string>
+#include <unity.h>
+#include "PN532_Sim.h"
+#include "NTAG21x_Sim.h"
+#include "Arduino.h"
+
+void setup(void);
+void loop(void);
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static std::string output_m;                 // Everything the bridge sent on Serial
+static size_t checked_m = 0;                 // Output before this position is already checked
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Functions */
+/* Runs the firmware on the virtual clock; only the output of this run is checked */
+static void run_ms(unsigned long duration_ms) {
+  checked_m = output_m.size();
+  unsigned long long end_us = sim_now_us() + 1000ULL*duration_ms;
+  while (sim_now_us() < end_us) loop();
+}
+
+/* Sends one line to the bridge and runs the firmware for duration_ms */
+static void send_line_and_run(const char * line, unsigned long duration_ms) {
+  std::string text = std::string(line) + "\n";
+  sim_serial_inject(text.c_str());
+  run_ms(duration_ms);
+}
+
+/* Position of a complete output line in the new output (std::string::npos: not sent) */
+static size_t find_line(const char * line) {
+  std::string expected = std::string(line) + "\r\n";
+  size_t position = output_m.find(expected, checked_m);
+  if ((position != std::string::npos) && (position > 0) && (output_m[position - 1] != '\n')) {
+    return std::string::npos;   // Only the end of another line
+  }
+  return position;
+}
+
+static unsigned count_lines_starting_with(const char * prefix) {
+  unsigned count = 0;
+  for (size_t position = output_m.find(prefix, checked_m); position != std::string::npos;
+       position = output_m.find(prefix, position + 1)) {
+    if ((position == 0) || (output_m[position - 1] == '\n')) count++;
+  }
+  return count;
+}
+/* >> END: Internal Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Tests */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* "C:F" while the start-up measurement is running: accepted at once, done after the measurement */
+void test_continuous_off_is_acknowledged(void) {
+  send_line_and_run("C:F", 3000);
+  size_t ack = find_line("ACK:0;Cmd:C;Q:1;");
+  size_t done = find_line("DONE:0;Cmd:C;Err:0;");
+  TEST_ASSERT_TRUE(ack != std::string::npos);
+  TEST_ASSERT_TRUE(done != std::string::npos);
+  TEST_ASSERT_TRUE(ack < done);
+}
+
+/* Continuous measurement is off: no measurement without a command */
+void test_no_measurement_while_continuous_off(void) {
+  run_ms(5000);
+  TEST_ASSERT_EQUAL(0, count_lines_starting_with("UID:"));
+}
+
+/* "M": one measurement with the UID prefix, DONE after the measurement line */
+void test_single_measurement_output(void) {
+  send_line_and_run("M", 3000);
+  size_t ack = find_line("ACK:1;Cmd:M;Q:1;");
+  size_t measurement = find_line("UID:045A1B923C6E80;Do:01;No:2;SS:124;MS:458;RSQPB:1206;");
+  size_t done = find_line("DONE:1;Cmd:M;Err:0;");
+  TEST_ASSERT_TRUE(ack != std::string::npos);
+  TEST_ASSERT_TRUE(measurement != std::string::npos);
+  TEST_ASSERT_TRUE(done != std::string::npos);
+  TEST_ASSERT_TRUE(ack < measurement);
+  TEST_ASSERT_TRUE(measurement < done);
+  TEST_ASSERT_EQUAL(1, count_lines_starting_with("UID:"));
+}
+
+/* Unknown command: rejected with the own sequence number, the code is echoed unchanged */
+void test_unknown_command_is_rejected(void) {
+  send_line_and_run("1", 500);
+  TEST_ASSERT_TRUE(find_line("NAK:2;Cmd:1;Err:80;") != std::string::npos);
+}
+/* >> END: Tests */
+
+
+int main(int argc, char ** argv) {
+  (void)argc;
+  (void)argv;
+  static const uint8_t uid[SIM_TAG_UID_LENGTH] = {0x04, 0x5A, 0x1B, 0x92, 0x3C, 0x6E, 0x80};
+  ThmsTagSim tag(uid);
+  tag.setResponseDelayMs(300);
+  PN532Sim pn532;
+  pn532.addTag(&tag);
+  pn532.attachI2C(2);
+  sim_serial_capture(&output_m);
+  setup();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_continuous_off_is_acknowledged);
+  RUN_TEST(test_no_measurement_while_continuous_off);
+  RUN_TEST(test_single_measurement_output);
+  RUN_TEST(test_unknown_command_is_rejected);
+  return UNITY_END();
+}
@@ -0,0 +1,127 @@
+/**************************************************************************/
+/*!
+ *   @file: test_main.cpp (test_format)
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Zahlen-Parser fmt_parse_uint() und Hex-/Dezimalausgabe aus
+ *             THMS_Format (Grenzwerte, Präfix, Fehlerfälle).
+ *             Aufruf: pio test -e native -f test_format
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <unity.h>
+#include <THMS_Format.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Tests */
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_parse_hex_with_prefix(void) {
+  uint32_t value = 0;
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint("0x1F", 16, 0xFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(0x1F, value);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint("0Xa0", 16, 0xFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(0xA0, value);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint("ff", 16, 0xFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(0xFF, value);
+}
+
+/* "0x" is only a prefix in base 16 */
+void test_parse_decimal_ignores_prefix(void) {
+  uint32_t value = 7;
+  TEST_ASSERT_EQUAL(FMT_INVALID, fmt_parse_uint("0x10", 10, 0xFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(7, value);
+}
+
+void test_parse_max_value(void) {
+  uint32_t value = 0;
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint("65535", 10, 0xFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(65535, value);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint("4294967295", 10, 0xFFFFFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(4294967295UL, value);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint("0xFF", 16, 0xFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(0xFF, value);
+}
+
+/* max + 1, also where number*base + digit overflows 32 bit; value stays unchanged */
+void test_parse_max_plus_one(void) {
+  uint32_t value = 7;
+  TEST_ASSERT_EQUAL(FMT_OUT_OF_RANGE, fmt_parse_uint("65536", 10, 0xFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL(FMT_OUT_OF_RANGE, fmt_parse_uint("4294967296", 10, 0xFFFFFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL(FMT_OUT_OF_RANGE, fmt_parse_uint("0x100", 16, 0xFF, &value, NULL));
+  TEST_ASSERT_EQUAL(FMT_OUT_OF_RANGE, fmt_parse_uint("100000000", 16, 0xFFFFFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(7, value);
+}
+
+void test_parse_empty_string(void) {
+  uint32_t value = 7;
+  const char * end = NULL;
+  TEST_ASSERT_EQUAL(FMT_NO_DIGITS, fmt_parse_uint("", 10, 0xFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL(FMT_NO_DIGITS, fmt_parse_uint("", 16, 0xFF, &value, &end));
+  TEST_ASSERT_EQUAL(FMT_NO_DIGITS, fmt_parse_uint(";", 10, 0xFFFF, &value, &end));
+  TEST_ASSERT_EQUAL_UINT32(7, value);
+}
+
+/* Lone "0x": the 0 is the number, 'x' follows it */
+void test_parse_lone_prefix(void) {
+  const char * text = "0x";
+  uint32_t value = 7;
+  const char * end = NULL;
+  TEST_ASSERT_EQUAL(FMT_INVALID, fmt_parse_uint(text, 16, 0xFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(7, value);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint(text, 16, 0xFF, &value, &end));
+  TEST_ASSERT_EQUAL_UINT32(0, value);
+  TEST_ASSERT_EQUAL_PTR(&text[1], end);
+}
+
+void test_parse_trailing_garbage(void) {
+  const char * text = "12a;";
+  uint32_t value = 7;
+  const char * end = NULL;
+  TEST_ASSERT_EQUAL(FMT_INVALID, fmt_parse_uint(text, 10, 0xFFFF, &value, NULL));
+  TEST_ASSERT_EQUAL_UINT32(7, value);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint(text, 10, 0xFFFF, &value, &end));
+  TEST_ASSERT_EQUAL_UINT32(12, value);
+  TEST_ASSERT_EQUAL_PTR(&text[2], end);
+  TEST_ASSERT_EQUAL(FMT_OK, fmt_parse_uint(text, 16, 0xFFFF, &value, &end));
+  TEST_ASSERT_EQUAL_UINT32(0x12A, value);
+  TEST_ASSERT_EQUAL_PTR(&text[3], end);
+}
+
+void test_hex_and_decimal_output(void) {
+  char text[FMT_UDEC_MAX_LENGTH + 1];
+  text[fmt_hex(text, 0x0CA5, 0)] = '\0';
+  TEST_ASSERT_EQUAL_STRING("CA5", text);
+  text[fmt_hex(text, 0x0CA5, 4)] = '\0';
+  TEST_ASSERT_EQUAL_STRING("0CA5", text);
+  text[fmt_hex(text, 0, 0)] = '\0';
+  TEST_ASSERT_EQUAL_STRING("0", text);
+  text[fmt_udec(text, 0)] = '\0';
+  TEST_ASSERT_EQUAL_STRING("0", text);
+  text[fmt_udec(text, 1203)] = '\0';
+  TEST_ASSERT_EQUAL_STRING("1203", text);
+  text[fmt_udec(text, 4294967295UL)] = '\0';
+  TEST_ASSERT_EQUAL_STRING("4294967295", text);
+}
+/* >> END: Tests */
+
+
+int main(int argc, char ** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_hex_with_prefix);
+  RUN_TEST(test_parse_decimal_ignores_prefix);
+  RUN_TEST(test_parse_max_value);
+  RUN_TEST(test_parse_max_plus_one);
+  RUN_TEST(test_parse_empty_string);
+  RUN_TEST(test_parse_lone_prefix);
+  RUN_TEST(test_parse_trailing_garbage);
+  RUN_TEST(test_hex_and_decimal_output);
+  return UNITY_END();
+}
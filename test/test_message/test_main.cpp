@@ -0,0 +1,122 @@
+/**************************************************************************/
+/*!
+ *   @file: test_main.cpp (test_message)
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: Zerlegung der Tag-Nachrichten ("key:value;") mit
+ *             thms_message_parse(): gültige, abgeschnittene und fehlerhafte
+ *             Nachrichten sowie unbekannte Schlüssel.
+ *             Aufruf: pio test -e native -f test_message
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <unity.h>
+#include <THMS_Message.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Tests */
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_valid_measurement(void) {
+  thms_message_t message;
+  TEST_ASSERT_TRUE(thms_message_parse("Do:01;No:1;SS:123;MS:456;RSQPB:1203;", &message));
+  TEST_ASSERT_EQUAL_HEX8(0x01, message.do_instruction);
+  TEST_ASSERT_EQUAL_UINT16(1, message.no);
+  TEST_ASSERT_EQUAL_UINT16(123, message.ss);
+  TEST_ASSERT_EQUAL_UINT16(456, message.ms);
+  TEST_ASSERT_EQUAL_UINT16(1203, message.rsqpb);
+  TEST_ASSERT_EQUAL_HEX8(THMS_FIELDS_MEASUREMENT, message.fields);
+  TEST_ASSERT_EQUAL_UINT8(0, message.unknown_keys);
+  TEST_ASSERT_TRUE(thms_message_is_measurement(&message));
+  TEST_ASSERT_FALSE(thms_message_is_error(&message));
+}
+
+/* Last pair without ';', largest values */
+void test_valid_without_last_separator(void) {
+  thms_message_t message;
+  TEST_ASSERT_TRUE(thms_message_parse("Do:1;No:65535;SS:0;MS:65535;RSQPB:7", &message));
+  TEST_ASSERT_EQUAL_UINT16(65535, message.no);
+  TEST_ASSERT_EQUAL_UINT16(7, message.rsqpb);
+  TEST_ASSERT_TRUE(thms_message_is_measurement(&message));
+}
+
+void test_valid_error_reply(void) {
+  thms_message_t message;
+  TEST_ASSERT_TRUE(thms_message_parse("Do:FF;", &message));
+  TEST_ASSERT_EQUAL_HEX8(THMS_FIELD_DO, message.fields);
+  TEST_ASSERT_TRUE(thms_message_is_error(&message));
+  TEST_ASSERT_FALSE(thms_message_is_measurement(&message));
+}
+
+void test_empty_message(void) {
+  thms_message_t message;
+  TEST_ASSERT_TRUE(thms_message_parse("", &message));
+  TEST_ASSERT_EQUAL_HEX8(0, message.fields);
+}
+
+/* Cut off after a complete pair: valid syntax, but no measurement */
+void test_truncated_after_pair(void) {
+  thms_message_t message;
+  TEST_ASSERT_TRUE(thms_message_parse("Do:01;No:1;SS:123;", &message));
+  TEST_ASSERT_EQUAL_HEX8(THMS_FIELD_DO | THMS_FIELD_NO | THMS_FIELD_SS, message.fields);
+  TEST_ASSERT_EQUAL_UINT16(0, message.ms);
+  TEST_ASSERT_FALSE(thms_message_is_measurement(&message));
+}
+
+/* Cut off inside a key or before the value */
+void test_truncated_inside_pair(void) {
+  thms_message_t message;
+  TEST_ASSERT_FALSE(thms_message_parse("Do:01;No:1;SS:123;MS", &message));
+  TEST_ASSERT_FALSE(thms_message_parse("Do:01;No:1;SS:123;MS:", &message));
+  TEST_ASSERT_FALSE(thms_message_parse("Do:01;No:1;SS:;", &message));
+  TEST_ASSERT_FALSE(thms_message_parse(";No:1;", &message));
+}
+
+void test_value_out_of_range(void) {
+  thms_message_t message;
+  TEST_ASSERT_FALSE(thms_message_parse("Do:01;No:65536;", &message));
+  TEST_ASSERT_FALSE(thms_message_parse("Do:01;No:1;SS:123;MS:456;RSQPB:99999;", &message));
+  TEST_ASSERT_FALSE(thms_message_parse("Do:100;", &message));
+}
+
+void test_invalid_value(void) {
+  thms_message_t message;
+  TEST_ASSERT_FALSE(thms_message_parse("Do:01;No:1x;", &message));
+  TEST_ASSERT_FALSE(thms_message_parse("Do:0G;", &message));
+  TEST_ASSERT_FALSE(thms_message_parse("No:-1;", &message));
+}
+
+/* Values of unknown keys are skipped and counted, whatever they contain */
+void test_unknown_keys(void) {
+  thms_message_t message;
+  TEST_ASSERT_TRUE(thms_message_parse("Do:06;PL:100;FW:1.3;No:5;ST:", &message));
+  TEST_ASSERT_EQUAL_UINT8(3, message.unknown_keys);
+  TEST_ASSERT_EQUAL_HEX8(THMS_FIELD_DO | THMS_FIELD_NO, message.fields);
+  TEST_ASSERT_EQUAL_HEX8(0x06, message.do_instruction);
+  TEST_ASSERT_EQUAL_UINT16(5, message.no);
+  TEST_ASSERT_TRUE(thms_message_parse("do:01;RSQP:1;", &message));   // Keys are case sensitive
+  TEST_ASSERT_EQUAL_UINT8(2, message.unknown_keys);
+  TEST_ASSERT_EQUAL_HEX8(0, message.fields);
+}
+/* >> END: Tests */
+
+
+int main(int argc, char ** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_valid_measurement);
+  RUN_TEST(test_valid_without_last_separator);
+  RUN_TEST(test_valid_error_reply);
+  RUN_TEST(test_empty_message);
+  RUN_TEST(test_truncated_after_pair);
+  RUN_TEST(test_truncated_inside_pair);
+  RUN_TEST(test_value_out_of_range);
+  RUN_TEST(test_invalid_value);
+  RUN_TEST(test_unknown_keys);
+  return UNITY_END();
+}
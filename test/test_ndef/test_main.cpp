@@ -0,0 +1,230 @@
+/**************************************************************************/
+/*!
+ *   @file: test_main.cpp (test_ndef)
+ *   @autor: Pascal Flint, David Schönfisch (Hochschule Kaiserslautern)
+ *
+ *   @details: NDEF-Auswertung von NT2S_read_ndef_text() (TLV-Suche und
+ *             Text-Record). Der Speicher des simulierten NTAG213 wird je Test
+ *             direkt beschrieben und über den simulierten PN532 gelesen.
+ *             Aufruf: pio test -e native -f test_ndef
+ *   @date: 17.10.2026
+ *
+ *   @version: V1.0
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <unity.h>
+#include "PN532_Sim.h"
+#include "NTAG21x_Sim.h"
+#include "Arduino.h"
+#include <NFC_THMS_to_Serial.h>
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Symbols, Enums, Macros & Typedefs*/
+#define NDEF_BUFFER_LENGTH    81    // As MAXIMAL_NDEF_MESSAGE_LENGT of the bridge
+
+/* NTAG213 that counts READ/FAST_READ and can leave FAST_READs unanswered (RF glitch) */
+class CountingNtagSim : public Ntag21xSim {
+public:
+  CountingNtagSim(const uint8_t uid[SIM_TAG_UID_LENGTH]) : Ntag21xSim(NTAG213, uid) {}
+  bool transceive(const uint8_t * command, size_t length, std::vector<uint8_t> & response) {
+    if (command[0] == 0x30) reads++;
+    if (command[0] == 0x3A) {
+      fast_reads++;
+      if (fast_reads_to_drop > 0) {
+        fast_reads_to_drop--;
+        response.clear();
+        return false;
+      }
+    }
+    return Ntag21xSim::transceive(command, length, response);
+  }
+  unsigned reads = 0;
+  unsigned fast_reads = 0;
+  unsigned fast_reads_to_drop = 0;
+};
+/* >> END: Symbols, Enums, Macros & Typedefs */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Variables */
+static const uint8_t uid_m[SIM_TAG_UID_LENGTH] = {0x04, 0x5A, 0x1B, 0x92, 0x3C, 0x6E, 0x80};
+static CountingNtagSim tag_m(uid_m);
+static PN532Sim pn532_m;
+static uint8_t message_m[NDEF_BUFFER_LENGTH];
+/* >> END: Internal Variables */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Internal Functions */
+/* Clears the data area (size from the CC) and writes the given bytes to its start */
+static void write_data_area(const uint8_t data[], size_t length) {
+  size_t data_area_size = 8*tag_m.page(3)[2];
+  memset(tag_m.page(4), 0x00, data_area_size);
+  memcpy(tag_m.page(4), data, length);
+}
+
+/* Appends a short NDEF text record (MB, ME, SR, well known type 'T') to data */
+static size_t append_text_record(uint8_t data[], size_t length, const char * language, const char * text) {
+  size_t language_length = strlen(language);
+  size_t text_length = strlen(text);
+  data[length++] = 0xD1;
+  data[length++] = 0x01;
+  data[length++] = (uint8_t)(1 + language_length + text_length);
+  data[length++] = 'T';
+  data[length++] = (uint8_t)language_length;
+  memcpy(&data[length], language, language_length);
+  length += language_length;
+  memcpy(&data[length], text, text_length);
+  return length + text_length;
+}
+
+/* NDEF TLV (1 byte length) with one text record */
+static size_t build_ndef_tlv(uint8_t data[], const char * language, const char * text) {
+  size_t length = append_text_record(data, 2, language, text);
+  data[0] = 0x03;
+  data[1] = (uint8_t)(length - 2);
+  return length;
+}
+
+static bool read_text(void) {
+  memset(message_m, 0xAA, sizeof(message_m));
+  return NT2S_read_ndef_text(message_m, NDEF_BUFFER_LENGTH);
+}
+/* >> END: Internal Functions */
+
+
+/*>>>------------------------------------------------------------*/
+/* >> START: Tests */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* Runs first: the PN532 and the tag are set up once for all tests */
+void test_sensor_tag_found(void) {
+  TEST_ASSERT_TRUE(init_NT2S());
+  TEST_ASSERT_EQUAL(1, NT2S_search_sensors());
+}
+
+void test_text_record_en_us(void) {
+  uint8_t data[64];
+  size_t length = build_ndef_tlv(data, "en-US", "Do:01;No:7;");
+  data[length++] = 0xFE;
+  write_data_area(data, length);
+  TEST_ASSERT_TRUE(read_text());
+  TEST_ASSERT_EQUAL_STRING("Do:01;No:7;", (const char *)message_m);
+}
+
+/* Lock Control TLV (0x01) before the NDEF TLV is skipped */
+void test_leading_lock_control_tlv(void) {
+  static const uint8_t lock_control[] = {0x01, 0x03, 0xA0, 0x0C, 0x34};
+  uint8_t data[64];
+  memcpy(data, lock_control, sizeof(lock_control));
+  size_t length = sizeof(lock_control);
+  length += build_ndef_tlv(&data[length], "de", "Do:01;SS:123;");
+  data[length++] = 0xFE;
+  write_data_area(data, length);
+  TEST_ASSERT_TRUE(read_text());
+  TEST_ASSERT_EQUAL_STRING("Do:01;SS:123;", (const char *)message_m);
+}
+
+/* 70 characters: TLV header + record (2 + 77 bytes) and '\0' still fit into the buffer */
+void test_text_of_70_characters(void) {
+  char text[71];
+  for (uint8_t i = 0; i < 70; i++) text[i] = 'a' + (i % 26);
+  text[70] = '\0';
+  uint8_t data[96];
+  size_t length = build_ndef_tlv(data, "de", text);
+  data[length++] = 0xFE;
+  write_data_area(data, length);
+  TEST_ASSERT_TRUE(read_text());
+  TEST_ASSERT_EQUAL_STRING(text, (const char *)message_m);
+}
+
+/* Message longer than the buffer: rejected */
+void test_text_too_long(void) {
+  char text[81];
+  for (uint8_t i = 0; i < 80; i++) text[i] = 'A' + (i % 26);
+  text[80] = '\0';
+  uint8_t data[112];
+  size_t length = build_ndef_tlv(data, "de", text);
+  data[length++] = 0xFE;
+  write_data_area(data, length);
+  TEST_ASSERT_FALSE(read_text());
+}
+
+/* No terminator TLV behind the message: the NDEF TLV length is enough */
+void test_missing_terminator(void) {
+  uint8_t data[64];
+  size_t length = build_ndef_tlv(data, "de", "Do:02;");
+  data[length++] = 0x55;   // Garbage instead of 0xFE
+  data[length++] = 0x55;
+  write_data_area(data, length);
+  TEST_ASSERT_TRUE(read_text());
+  TEST_ASSERT_EQUAL_STRING("Do:02;", (const char *)message_m);
+}
+
+/* Terminator before any NDEF TLV: no message */
+void test_terminator_without_ndef_tlv(void) {
+  static const uint8_t data[] = {0x00, 0x00, 0xFE};
+  write_data_area(data, sizeof(data));
+  TEST_ASSERT_FALSE(read_text());
+}
+
+/* NDEF TLV with 3 byte length field (0xFF + 2 bytes) */
+void test_three_byte_length_tlv(void) {
+  uint8_t data[64];
+  size_t length = append_text_record(data, 4, "de", "Do:01;MS:456;");
+  data[0] = 0x03;
+  data[1] = 0xFF;
+  data[2] = 0x00;
+  data[3] = (uint8_t)(length - 4);
+  data[length++] = 0xFE;
+  write_data_area(data, length);
+  TEST_ASSERT_TRUE(read_text());
+  TEST_ASSERT_EQUAL_STRING("Do:01;MS:456;", (const char *)message_m);
+}
+/* A FAST_READ without answer is repeated by the next call; the tag is not switched to READ */
+void test_fast_read_kept_after_rf_glitch(void) {
+  uint8_t data[64];
+  size_t length = build_ndef_tlv(data, "de", "Do:01;RSQPB:1203;");
+  data[length++] = 0xFE;
+  write_data_area(data, length);
+  tag_m.reads = 0;
+  tag_m.fast_reads_to_drop = 1;
+  TEST_ASSERT_FALSE(read_text());   // The library does not wait for the retry itself
+  uint16_t retry_after_ms = NT2S_retry_after_ms();
+  TEST_ASSERT_TRUE(retry_after_ms > 0);
+  TEST_ASSERT_EQUAL_UINT8(0, NT2S_get_sensor(NT2S_selected_sensor())->failures);   // Not given up yet
+  delay(retry_after_ms);
+  TEST_ASSERT_TRUE(read_text());    // Next call continues the access
+  TEST_ASSERT_EQUAL_UINT16(0, NT2S_retry_after_ms());
+  TEST_ASSERT_EQUAL_STRING("Do:01;RSQPB:1203;", (const char *)message_m);
+  TEST_ASSERT_EQUAL(0, tag_m.reads);
+  unsigned fast_reads = tag_m.fast_reads;
+  TEST_ASSERT_TRUE(read_text());
+  TEST_ASSERT_TRUE(tag_m.fast_reads > fast_reads);
+  TEST_ASSERT_EQUAL(0, tag_m.reads);
+}
+/* >> END: Tests */
+
+
+int main(int argc, char ** argv) {
+  (void)argc;
+  (void)argv;
+  pn532_m.addTag(&tag_m);
+  pn532_m.attachI2C(2);
+  NT2S_set_debug_output(false);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_sensor_tag_found);
+  RUN_TEST(test_text_record_en_us);
+  RUN_TEST(test_leading_lock_control_tlv);
+  RUN_TEST(test_text_of_70_characters);
+  RUN_TEST(test_text_too_long);
+  RUN_TEST(test_missing_terminator);
+  RUN_TEST(test_terminator_without_ndef_tlv);
+  RUN_TEST(test_three_byte_length_tlv);
+  RUN_TEST(test_fast_read_kept_after_rf_glitch);
+  return UNITY_END();
+}